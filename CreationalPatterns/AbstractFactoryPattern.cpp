@@ -11,62 +11,356 @@
 // In this example, Abstract Product Interfaces (ProductTypeA and ProductTypeB) define the common methods that concrete product classes must implement.
 // Concrete Products (ConcreteProductA1, ConcreteProductA2, ConcreteProductB1, and ConcreteProductB2) are the actual implementations of the abstract product interfaces.
 // Abstract Factory Interface (AbstractFactory) declares methods for creating product objects. Concrete factories (ConcreteFactory1 and ConcreteFactory2) implement these methods to create specific families of products.
+// The product behaviour itself lives in non-virtual classes grouped into families (ProductFamily1, ProductFamily2).
+// StaticFactory<Family> builds them directly when the family is known at compile time, which lets collaborate() inline
+// across the family; the runtime ConcreteProducts and ConcreteFactories are adapters over those same classes.
+// createProductsA/B(n) and createFamilies(n) build products in bulk into contiguous per-type arrays, and
+// FamilyBatch::collaborateAll() walks the pairs in order with no pointer chasing.
+// Run the program with "--bench" to compare the cost of a collaborate call through both forms, and batched against one-by-one families.
+// Each create method also has an overload taking a FamilyArena, which bump-allocates the products of families that are
+// released together and returns a ProductHandle instead of a heap-allocated unique_ptr.
 
 
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <chrono>
+#include <utility>
 
 // Abstract Product Interfaces
 class ProductTypeA {
 public:
+    virtual ~ProductTypeA() = default;
     virtual void performAction() const = 0;
 };
 
 class ProductTypeB {
 public:
+    virtual ~ProductTypeB() = default;
     virtual void performAction() const = 0;
     virtual void collaborate(const ProductTypeA& collaborator) const = 0;
 };
 
-// Concrete Products
-class ConcreteProductA1 : public ProductTypeA {
+// Static Product Families
+// The product behaviour lives in plain classes without virtual functions. When the family is known at compile time
+// they are used directly, so collaborate() is resolved statically and inlines through the collaborator.
+class ProductA1 {
 public:
-    void performAction() const override {
+    void performAction() const {
         std::cout << "Performing action of Product A1." << std::endl;
     }
+
+    int actionCode() const {
+        return code;
+    }
+
+private:
+    int code = 1; // held per product, so walking a batch has to read every product
 };
 
-class ConcreteProductA2 : public ProductTypeA {
+class ProductA2 {
 public:
-    void performAction() const override {
+    void performAction() const {
         std::cout << "Performing action of Product A2." << std::endl;
     }
+
+    int actionCode() const {
+        return code;
+    }
+
+private:
+    int code = 2; // held per product, so walking a batch has to read every product
 };
 
-class ConcreteProductB1 : public ProductTypeB {
+class ProductB1 {
 public:
-    void performAction() const override {
+    void performAction() const {
         std::cout << "Performing action of Product B1." << std::endl;
     }
 
-    void collaborate(const ProductTypeA& collaborator) const override {
+    template <typename ProductA>
+    void collaborate(const ProductA& collaborator) const {
         std::cout << "Product B1 collaborating with (";
         collaborator.performAction();
         std::cout << ")" << std::endl;
     }
+
+    template <typename ProductA>
+    int collaborateCode(const ProductA& collaborator) const {
+        return code + collaborator.actionCode();
+    }
+
+private:
+    int code = 10;
 };
 
-class ConcreteProductB2 : public ProductTypeB {
+class ProductB2 {
 public:
-    void performAction() const override {
+    void performAction() const {
         std::cout << "Performing action of Product B2." << std::endl;
     }
 
-    void collaborate(const ProductTypeA& collaborator) const override {
+    template <typename ProductA>
+    void collaborate(const ProductA& collaborator) const {
         std::cout << "Product B2 collaborating with (";
         collaborator.performAction();
         std::cout << ")" << std::endl;
     }
+
+    template <typename ProductA>
+    int collaborateCode(const ProductA& collaborator) const {
+        return code + collaborator.actionCode();
+    }
+
+private:
+    int code = 20;
+};
+
+// A family is just the pair of product types that belong together
+struct ProductFamily1 {
+    using ProductA = ProductA1;
+    using ProductB = ProductB1;
+};
+
+struct ProductFamily2 {
+    using ProductA = ProductA2;
+    using ProductB = ProductB2;
+};
+
+// Compile-time factory: the family type parameter picks the concrete products, returned by value
+template <typename Family>
+class StaticFactory {
+public:
+    using ProductA = typename Family::ProductA;
+    using ProductB = typename Family::ProductB;
+
+    static ProductA createProductA() {
+        return ProductA();
+    }
+
+    static ProductB createProductB() {
+        return ProductB();
+    }
+};
+
+// Benchmark Hooks
+// Side-effect free counterparts of performAction() and collaborate(), used when measuring dispatch cost so console
+// output does not drown it out. They are kept off the product interfaces; only the runtime adapters implement them.
+class BenchmarkProductA {
+public:
+    virtual ~BenchmarkProductA() = default;
+    virtual int actionCode() const = 0;
+};
+
+class BenchmarkProductB {
+public:
+    virtual ~BenchmarkProductB() = default;
+    virtual int collaborateCode(const BenchmarkProductA& collaborator) const = 0;
+};
+
+// Concrete Products
+// The runtime-polymorphic products are thin adapters forwarding to the static implementations.
+template <typename Impl>
+class RuntimeProductA final : public ProductTypeA, public BenchmarkProductA {
+public:
+    const Impl& implementation() const {
+        return impl;
+    }
+
+    void performAction() const override {
+        impl.performAction();
+    }
+
+    int actionCode() const override {
+        return impl.actionCode();
+    }
+
+private:
+    Impl impl;
+};
+
+template <typename Impl>
+class RuntimeProductB final : public ProductTypeB, public BenchmarkProductB {
+public:
+    const Impl& implementation() const {
+        return impl;
+    }
+
+    void performAction() const override {
+        impl.performAction();
+    }
+
+    void collaborate(const ProductTypeA& collaborator) const override {
+        impl.collaborate(collaborator);
+    }
+
+    int collaborateCode(const BenchmarkProductA& collaborator) const override {
+        return impl.collaborateCode(collaborator);
+    }
+
+private:
+    Impl impl;
+};
+
+using ConcreteProductA1 = RuntimeProductA<ProductA1>;
+using ConcreteProductA2 = RuntimeProductA<ProductA2>;
+using ConcreteProductB1 = RuntimeProductB<ProductB1>;
+using ConcreteProductB2 = RuntimeProductB<ProductB2>;
+
+// Family Arena
+// The products of a family are made to be used together, so they are usually created together and released together.
+// Instead of one std::make_unique per product, a factory can place them in a FamilyArena: bump allocation out of
+// chunks that stay with the arena and are reused once reset() releases every family at once. The returned
+// ProductHandle only runs the destructor, since the memory belongs to the arena.
+class FamilyArena {
+public:
+    explicit FamilyArena(std::size_t chunkSize = 64 * 1024) : chunkSize(chunkSize) {}
+
+    // Alignment is applied to the address, so it holds beyond what the chunk memory itself is aligned to
+    void* allocate(std::size_t size, std::size_t alignment) {
+        if (current < chunks.size()) {
+            if (void* memory = fit(chunks[current], size, alignment)) {
+                return memory;
+            }
+        }
+        // Move on to the next kept chunk, or add one, until the request fits
+        for (++current; current < chunks.size(); ++current) {
+            offset = 0;
+            if (void* memory = fit(chunks[current], size, alignment)) {
+                return memory;
+            }
+        }
+        std::size_t chunkBytes = std::max(chunkSize, size + alignment - 1);
+        chunks.push_back({std::make_unique<unsigned char[]>(chunkBytes), chunkBytes});
+        current = chunks.size() - 1;
+        offset = 0;
+        return fit(chunks[current], size, alignment);
+    }
+
+    // Rewinds the arena so its chunks are reused. Every handle created from it must be destroyed first.
+    void reset() {
+        current = 0;
+        offset = 0;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> memory;
+        std::size_t size;
+    };
+
+    void* fit(const Chunk& chunk, std::size_t size, std::size_t alignment) {
+        void* memory = chunk.memory.get() + offset;
+        std::size_t space = chunk.size - offset;
+        if (!std::align(alignment, size, memory, space)) {
+            return nullptr;
+        }
+        offset = chunk.size - space + size;
+        return memory;
+    }
+
+    std::size_t chunkSize;
+    std::vector<Chunk> chunks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+};
+
+template <typename T>
+struct ProductDeleter {
+    void operator()(T* product) const {
+        product->~T();
+    }
+};
+
+template <typename T>
+using ProductHandle = std::unique_ptr<T, ProductDeleter<T>>;
+
+template <typename Interface, typename Concrete>
+ProductHandle<Interface> makeProduct(FamilyArena& arena) {
+    return ProductHandle<Interface>(new (arena.allocate(sizeof(Concrete), alignof(Concrete))) Concrete());
+}
+
+// Product Batches
+// Bulk creation keeps products of one concrete type side by side in a single vector instead of one heap object each.
+template <typename Interface>
+class ProductBatch {
+public:
+    virtual ~ProductBatch() = default;
+    virtual std::size_t size() const = 0;
+    virtual const Interface& at(std::size_t index) const = 0;
+};
+
+template <typename Interface, typename Concrete>
+class ContiguousBatch final : public ProductBatch<Interface> {
+public:
+    explicit ContiguousBatch(std::size_t count) : products(count) {}
+
+    std::size_t size() const override {
+        return products.size();
+    }
+
+    const Interface& at(std::size_t index) const override {
+        return products[index];
+    }
+
+private:
+    std::vector<Concrete> products;
+};
+
+// N A-products paired with N B-products, each kind in its own contiguous array
+class FamilyBatch {
+public:
+    virtual ~FamilyBatch() = default;
+    virtual std::size_t size() const = 0;
+    virtual const ProductTypeA& productA(std::size_t index) const = 0;
+    virtual const ProductTypeB& productB(std::size_t index) const = 0;
+    // Lets every B collaborate with the A at the same index, walking both arrays in order
+    virtual void collaborateAll() const = 0;
+    virtual long collaborateCodeSum() const = 0;
+};
+
+template <typename Family>
+class FamilyBatchOf final : public FamilyBatch {
+public:
+    using ProductA = RuntimeProductA<typename Family::ProductA>;
+    using ProductB = RuntimeProductB<typename Family::ProductB>;
+
+    explicit FamilyBatchOf(std::size_t count) : productsA(count), productsB(count) {}
+
+    std::size_t size() const override {
+        return productsA.size();
+    }
+
+    const ProductTypeA& productA(std::size_t index) const override {
+        return productsA[index];
+    }
+
+    const ProductTypeB& productB(std::size_t index) const override {
+        return productsB[index];
+    }
+
+    // The concrete types are known here, so the calls go straight to the family implementations
+    void collaborateAll() const override {
+        for (std::size_t i = 0; i < productsA.size(); ++i) {
+            productsB[i].implementation().collaborate(productsA[i].implementation());
+        }
+    }
+
+    long collaborateCodeSum() const override {
+        long sum = 0;
+        for (std::size_t i = 0; i < productsA.size(); ++i) {
+            sum += productsB[i].implementation().collaborateCode(productsA[i].implementation());
+        }
+        return sum;
+    }
+
+private:
+    std::vector<ProductA> productsA;
+    std::vector<ProductB> productsB;
 };
 
 // Abstract Factory Interface
@@ -74,34 +368,134 @@ class AbstractFactory {
 public:
     virtual std::unique_ptr<ProductTypeA> createProductA() const = 0;
     virtual std::unique_ptr<ProductTypeB> createProductB() const = 0;
+
+    // Arena backed creation for families that are released together
+    virtual ProductHandle<ProductTypeA> createProductA(FamilyArena& arena) const = 0;
+    virtual ProductHandle<ProductTypeB> createProductB(FamilyArena& arena) const = 0;
+
+    // Batch creation into contiguous, per-type storage
+    virtual std::unique_ptr<ProductBatch<ProductTypeA>> createProductsA(std::size_t count) const = 0;
+    virtual std::unique_ptr<ProductBatch<ProductTypeB>> createProductsB(std::size_t count) const = 0;
+    virtual std::unique_ptr<FamilyBatch> createFamilies(std::size_t count) const = 0;
+    virtual ~AbstractFactory() = default;
 };
 
 // Concrete Factories
-class ConcreteFactory1 : public AbstractFactory {
+// Runtime factory over a compile-time family, so both forms always build the same products
+template <typename Family>
+class FamilyFactory : public AbstractFactory {
 public:
+    using ProductA = RuntimeProductA<typename Family::ProductA>;
+    using ProductB = RuntimeProductB<typename Family::ProductB>;
+
     std::unique_ptr<ProductTypeA> createProductA() const override {
-        return std::make_unique<ConcreteProductA1>();
+        return std::make_unique<ProductA>();
     }
 
     std::unique_ptr<ProductTypeB> createProductB() const override {
-        return std::make_unique<ConcreteProductB1>();
+        return std::make_unique<ProductB>();
     }
-};
 
-class ConcreteFactory2 : public AbstractFactory {
-public:
-    std::unique_ptr<ProductTypeA> createProductA() const override {
-        return std::make_unique<ConcreteProductA2>();
+    ProductHandle<ProductTypeA> createProductA(FamilyArena& arena) const override {
+        return makeProduct<ProductTypeA, ProductA>(arena);
     }
 
-    std::unique_ptr<ProductTypeB> createProductB() const override {
-        return std::make_unique<ConcreteProductB2>();
+    ProductHandle<ProductTypeB> createProductB(FamilyArena& arena) const override {
+        return makeProduct<ProductTypeB, ProductB>(arena);
+    }
+
+    std::unique_ptr<ProductBatch<ProductTypeA>> createProductsA(std::size_t count) const override {
+        return std::make_unique<ContiguousBatch<ProductTypeA, ProductA>>(count);
+    }
+
+    std::unique_ptr<ProductBatch<ProductTypeB>> createProductsB(std::size_t count) const override {
+        return std::make_unique<ContiguousBatch<ProductTypeB, ProductB>>(count);
+    }
+
+    std::unique_ptr<FamilyBatch> createFamilies(std::size_t count) const override {
+        return std::make_unique<FamilyBatchOf<Family>>(count);
     }
 };
 
-int main() {
+class ConcreteFactory1 : public FamilyFactory<ProductFamily1> {};
+
+class ConcreteFactory2 : public FamilyFactory<ProductFamily2> {};
+
+// Benchmark: cost of one collaborate call through virtual dispatch versus the statically dispatched family.
+// collaborateCode() is used instead of collaborate(), through the benchmark hooks of the runtime products.
+void runBenchmark(const AbstractFactory& factory) {
+    const long calls = 200000000;
+    volatile int sink = 0;
+
+    std::unique_ptr<ProductTypeA> productA = factory.createProductA();
+    std::unique_ptr<ProductTypeB> productB = factory.createProductB();
+    const auto& hooksA = dynamic_cast<const BenchmarkProductA&>(*productA);
+    const auto& hooksB = dynamic_cast<const BenchmarkProductB&>(*productB);
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < calls; ++i) {
+        sink = hooksB.collaborateCode(hooksA);
+    }
+    std::chrono::duration<double, std::nano> virtualTime = std::chrono::steady_clock::now() - start;
+
+    StaticFactory<ProductFamily1>::ProductA staticA = StaticFactory<ProductFamily1>::createProductA();
+    StaticFactory<ProductFamily1>::ProductB staticB = StaticFactory<ProductFamily1>::createProductB();
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < calls; ++i) {
+        sink = staticB.collaborateCode(staticA);
+    }
+    std::chrono::duration<double, std::nano> staticTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "virtual dispatch: " << virtualTime.count() / calls << " ns/collaborate" << std::endl;
+    std::cout << "static dispatch: " << staticTime.count() / calls << " ns/collaborate" << std::endl;
+    (void)sink;
+
+    // Family-heavy workload: one heap object per product versus contiguous batches
+    const std::size_t families = 1000000;
+    start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<ProductTypeA>> singleA;
+    std::vector<std::unique_ptr<ProductTypeB>> singleB;
+    singleA.reserve(families);
+    singleB.reserve(families);
+    for (std::size_t i = 0; i < families; ++i) {
+        singleA.push_back(factory.createProductA());
+        singleB.push_back(factory.createProductB());
+    }
+    std::chrono::duration<double, std::milli> singleCreate = std::chrono::steady_clock::now() - start;
+    // Resolve the hooks up front so the walk below only pays for the virtual calls
+    std::vector<std::pair<const BenchmarkProductA*, const BenchmarkProductB*>> singleHooks;
+    singleHooks.reserve(families);
+    for (std::size_t i = 0; i < families; ++i) {
+        singleHooks.emplace_back(dynamic_cast<const BenchmarkProductA*>(singleA[i].get()),
+                                 dynamic_cast<const BenchmarkProductB*>(singleB[i].get()));
+    }
+    start = std::chrono::steady_clock::now();
+    long singleSum = 0;
+    for (const auto& [hookA, hookB] : singleHooks) {
+        singleSum += hookB->collaborateCode(*hookA);
+    }
+    std::chrono::duration<double, std::milli> singleWalk = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<FamilyBatch> batch = factory.createFamilies(families);
+    std::chrono::duration<double, std::milli> batchCreate = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    long batchSum = batch->collaborateCodeSum();
+    std::chrono::duration<double, std::milli> batchWalk = std::chrono::steady_clock::now() - start;
+
+    std::cout << families << " families one by one: create " << singleCreate.count() << " ms, collaborate "
+              << singleWalk.count() << " ms (sum " << singleSum << ")" << std::endl;
+    std::cout << families << " families batched: create " << batchCreate.count() << " ms, collaborate "
+              << batchWalk.count() << " ms (sum " << batchSum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
     // Use Concrete Factory 1
     std::unique_ptr<ConcreteFactory1> factory1 = std::make_unique<ConcreteFactory1>();
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark(*factory1);
+        return 0;
+    }
+
     std::unique_ptr<ProductTypeA> productA1 = factory1->createProductA();
     std::unique_ptr<ProductTypeB> productB1 = factory1->createProductB();
     productB1->collaborate(*productA1);
@@ -112,5 +506,23 @@ int main() {
     std::unique_ptr<ProductTypeB> productB2 = factory2->createProductB();
     productB2->collaborate(*productA2);
 
+    // Build a family inside an arena and release it in one step once done
+    FamilyArena arena;
+    {
+        ProductHandle<ProductTypeA> arenaProductA = factory1->createProductA(arena);
+        ProductHandle<ProductTypeB> arenaProductB = factory1->createProductB(arena);
+        arenaProductB->collaborate(*arenaProductA);
+    }
+    arena.reset();
+
+    // Same family resolved at compile time, no virtual calls involved
+    StaticFactory<ProductFamily2>::ProductA staticProductA = StaticFactory<ProductFamily2>::createProductA();
+    StaticFactory<ProductFamily2>::ProductB staticProductB = StaticFactory<ProductFamily2>::createProductB();
+    staticProductB.collaborate(staticProductA);
+
+    // Create several families at once, stored contiguously, and let each pair collaborate
+    std::unique_ptr<FamilyBatch> families = factory2->createFamilies(2);
+    families->collaborateAll();
+
     return 0;
 }
@@ -18,25 +18,163 @@
 // to construct different parts of the Product.
 // The Director class orchestrates the construction process by invoking the appropriate methods on the Builder 
 // object it is associated with. It provides a construct() method to guide the order of construction.
+// Parts are passed as std::string_view and each builder reserves the product's storage once from its known part sizes,
+// so assembling a product allocates at most once. With Product::Assembly::Segments the parts are only recorded as views
+// and concatenated when the product is rendered, which needs no allocation at all while building.
+// Builders are reusable: takeProduct() moves the finished product out and resets the builder, buffers of consumed products
+// go back to a PartBufferPool, and Director::constructMany() runs many construction jobs across threads, each thread using
+// a builder from a BuilderPool. Once the pools are warm, construction allocates nothing.
+// Run the program with "--bench" to measure products per second and heap allocations per product.
 
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <array>
+#include <vector>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <functional>
 
 // Product
 class Product {
 public:
-    void addPart(const std::string& part) {
-        parts_ += part + " ";
+    // Concatenated: parts are appended into one string, reserved up front so it grows only once.
+    // Segments: parts are kept as views and only joined when the product is rendered. The viewed characters
+    //           must outlive the product, which holds for the string literals the builders use.
+    enum class Assembly {
+        Concatenated,
+        Segments
+    };
+
+    explicit Product(Assembly assembly = Assembly::Concatenated) : assembly_(assembly) {}
+
+    // Builds into a recycled buffer, keeping whatever capacity it already has
+    Product(Assembly assembly, std::string buffer) : assembly_(assembly), parts_(std::move(buffer)) {
+        parts_.clear();
+    }
+
+    // Gives the string buffer back so it can be reused for another product
+    std::string releaseBuffer() {
+        segmentCount_ = 0;
+        overflow_.clear();
+        return std::move(parts_);
+    }
+
+    // Lets a builder that knows its parts in advance size the storage once
+    void reserve(std::size_t partCount, std::size_t partBytes) {
+        if (assembly_ == Assembly::Concatenated) {
+            parts_.reserve(partBytes + partCount); // one separator per part
+        } else if (partCount > kInlineSegments) {
+            overflow_.reserve(partCount - kInlineSegments);
+        }
+    }
+
+    void addPart(std::string_view part) {
+        if (assembly_ == Assembly::Concatenated) {
+            parts_.append(part);
+            parts_.push_back(' ');
+        } else if (segmentCount_ < kInlineSegments) {
+            segments_[segmentCount_++] = part;
+        } else {
+            overflow_.push_back(part);
+            ++segmentCount_;
+        }
+    }
+
+    // Length of the rendered product, without rendering it
+    std::size_t size() const {
+        if (assembly_ == Assembly::Concatenated) {
+            return parts_.size();
+        }
+        std::size_t size = 0;
+        forEachSegment([&size](std::string_view part) { size += part.size() + 1; });
+        return size;
+    }
+
+    std::string render() const {
+        if (assembly_ == Assembly::Concatenated) {
+            return parts_;
+        }
+        std::string rendered;
+        rendered.reserve(size());
+        forEachSegment([&rendered](std::string_view part) {
+            rendered.append(part);
+            rendered.push_back(' ');
+        });
+        return rendered;
     }
 
     void showProduct() const {
-        std::cout << "Product parts: " << parts_ << std::endl;
+        std::cout << "Product parts: ";
+        if (assembly_ == Assembly::Concatenated) {
+            std::cout << parts_;
+        } else {
+            forEachSegment([](std::string_view part) { std::cout << part << ' '; });
+        }
+        std::cout << std::endl;
     }
 
 private:
+    static constexpr std::size_t kInlineSegments = 8;
+
+    template <typename Visitor>
+    void forEachSegment(Visitor visit) const {
+        for (std::size_t i = 0; i < segmentCount_; ++i) {
+            visit(i < kInlineSegments ? segments_[i] : overflow_[i - kInlineSegments]);
+        }
+    }
+
+    Assembly assembly_;
     std::string parts_;
+    std::array<std::string_view, kInlineSegments> segments_{};
+    std::vector<std::string_view> overflow_; // only used past kInlineSegments parts
+    std::size_t segmentCount_ = 0;
+};
+
+// Total characters of a builder's fixed part list, so the product can reserve once
+template <std::size_t N>
+constexpr std::size_t totalLength(const std::string_view (&parts)[N]) {
+    std::size_t length = 0;
+    for (std::string_view part : parts) {
+        length += part.size();
+    }
+    return length;
+}
+
+// Part Buffer Pool
+// Finished products hand their string buffer back here once consumed, and builders take buffers from here when they
+// start a new product. In steady state products are built into recycled buffers and no new memory is allocated.
+class PartBufferPool {
+public:
+    std::string acquire() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (buffers.empty()) {
+            return std::string();
+        }
+        std::string buffer = std::move(buffers.back());
+        buffers.pop_back();
+        return buffer;
+    }
+
+    void release(std::string buffer) {
+        if (buffer.capacity() <= std::string().capacity()) {
+            return; // nothing worth keeping, the string never left its inline storage
+        }
+        buffer.clear(); // keeps the capacity
+        std::lock_guard<std::mutex> lock(mtx);
+        buffers.push_back(std::move(buffer));
+    }
+
+private:
+    std::mutex mtx;
+    std::vector<std::string> buffers;
 };
 
 // Abstract Builder
@@ -48,52 +186,127 @@ public:
     virtual void buildPartB() = 0;
     virtual void buildPartC() = 0;
     virtual Product* getProduct() = 0;
+
+    // Starts over with an empty product, reusing the current buffer
+    virtual void reset() = 0;
+    // Hands the finished product over by move and leaves the builder ready for the next one
+    virtual Product takeProduct() = 0;
+};
+
+// Shared state of the concrete builders: the product in progress, its assembly mode and where buffers come from
+class ReusableBuilder : public Builder {
+public:
+    Product* getProduct() override {
+        return &product_;
+    }
+
+    void reset() override {
+        std::string buffer = product_.releaseBuffer();
+        if (assembly_ == Product::Assembly::Concatenated && pool_ && buffer.capacity() < partBytes_ + partCount_) {
+            buffer = pool_->acquire();
+        }
+        product_ = Product(assembly_, std::move(buffer));
+        product_.reserve(partCount_, partBytes_);
+    }
+
+    Product takeProduct() override {
+        Product finished = std::move(product_);
+        reset();
+        return finished;
+    }
+
+protected:
+    template <std::size_t N>
+    ReusableBuilder(const std::string_view (&parts)[N], Product::Assembly assembly, PartBufferPool* pool)
+        : assembly_(assembly), pool_(pool), partCount_(N), partBytes_(totalLength(parts)) {
+        reset();
+    }
+
+    void addPart(std::string_view part) {
+        product_.addPart(part);
+    }
+
+private:
+    Product::Assembly assembly_;
+    PartBufferPool* pool_;
+    std::size_t partCount_;
+    std::size_t partBytes_;
+    Product product_;
 };
 
 // Concrete Builder 1
-class ConcreteBuilder1 : public Builder {
+class ConcreteBuilder1 : public ReusableBuilder {
 public:
+    explicit ConcreteBuilder1(Product::Assembly assembly = Product::Assembly::Concatenated, PartBufferPool* pool = nullptr)
+        : ReusableBuilder(kParts, assembly, pool) {}
+
     void buildPartA() override {
-        product_->addPart("PartA1");
+        addPart(kParts[0]);
     }
 
     void buildPartB() override {
-        product_->addPart("PartB1");
+        addPart(kParts[1]);
     }
 
     void buildPartC() override {
-        product_->addPart("PartC1");
-    }
-
-    Product* getProduct() override {
-        return product_.get();
+        addPart(kParts[2]);
     }
 
 private:
-    std::unique_ptr<Product> product_ = std::make_unique<Product>();
+    static constexpr std::string_view kParts[] = {"PartA1", "PartB1", "PartC1"};
 };
 
 // Concrete Builder 2
-class ConcreteBuilder2 : public Builder {
+class ConcreteBuilder2 : public ReusableBuilder {
 public:
+    explicit ConcreteBuilder2(Product::Assembly assembly = Product::Assembly::Concatenated, PartBufferPool* pool = nullptr)
+        : ReusableBuilder(kParts, assembly, pool) {}
+
     void buildPartA() override {
-        product_->addPart("PartA2");
+        addPart(kParts[0]);
     }
 
     void buildPartB() override {
-        product_->addPart("PartB2");
+        addPart(kParts[1]);
     }
 
     void buildPartC() override {
-        product_->addPart("PartC2");
+        addPart(kParts[2]);
     }
 
-    Product* getProduct() override {
-        return product_.get();
+private:
+    static constexpr std::string_view kParts[] = {"PartA2", "PartB2", "PartC2"};
+};
+
+// Builder Pool
+// Builders are created on demand and handed back after use, so concurrent jobs each get their own builder
+// without allocating a new one per product.
+class BuilderPool {
+public:
+    explicit BuilderPool(std::function<std::unique_ptr<Builder>()> makeBuilder) : makeBuilder(std::move(makeBuilder)) {}
+
+    std::unique_ptr<Builder> acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!builders.empty()) {
+                std::unique_ptr<Builder> builder = std::move(builders.back());
+                builders.pop_back();
+                return builder;
+            }
+        }
+        return makeBuilder();
+    }
+
+    void release(std::unique_ptr<Builder> builder) {
+        builder->reset();
+        std::lock_guard<std::mutex> lock(mtx);
+        builders.push_back(std::move(builder));
     }
 
 private:
-    std::unique_ptr<Product> product_ = std::make_unique<Product>();
+    std::function<std::unique_ptr<Builder>()> makeBuilder;
+    std::mutex mtx;
+    std::vector<std::unique_ptr<Builder>> builders;
 };
 
 // Director
@@ -105,20 +318,152 @@ public:
     }
 
     void construct() {
-        builder_->buildPartA();
-        builder_->buildPartB();
-        builder_->buildPartC();
+        construct(*builder_);
     }
     
     Product* getProduct() const {
         return builder_->getProduct();
     }
 
+    // Runs jobCount constructions on threadCount threads. Each thread takes its own builder from the pool,
+    // and every finished product is moved into consume(), which may be called from several threads at once.
+    template <typename Consume>
+    static void constructMany(BuilderPool& pool, std::size_t jobCount, std::size_t threadCount, Consume consume) {
+        std::atomic<std::size_t> nextJob{0};
+        auto worker = [&pool, &nextJob, &consume, jobCount]() {
+            std::unique_ptr<Builder> builder = pool.acquire();
+            while (nextJob.fetch_add(1, std::memory_order_relaxed) < jobCount) {
+                construct(*builder);
+                consume(builder->takeProduct());
+            }
+            pool.release(std::move(builder));
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < threadCount; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker(); // the calling thread works too
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
 private:
+    static void construct(Builder& builder) {
+        builder.buildPartA();
+        builder.buildPartB();
+        builder.buildPartC();
+    }
+
     std::unique_ptr<Builder> builder_;
 };
 
-int main() {
+// Counts every global operator new so the benchmark can report heap allocations.
+// The replacements are kept out of line so GCC does not mistake the inlined malloc/free for mismatched allocations.
+std::atomic<long> heapAllocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// The original assembly: a temporary per part plus string growth, for comparison only
+class LegacyProduct {
+public:
+    void addPart(const std::string& part) {
+        parts_ += part + " ";
+    }
+
+    std::size_t size() const {
+        return parts_.size();
+    }
+
+private:
+    std::string parts_;
+};
+
+template <typename Build>
+void benchmarkAssembly(const char* label, Build build) {
+    const long products = 2000000;
+    std::size_t checksum = 0;
+    long before = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < products; ++i) {
+        checksum += build();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << label << ": " << products / elapsed.count() << " products/sec, "
+              << static_cast<double>(heapAllocations - before) / products << " heap allocations/product"
+              << " (checksum " << checksum << ")" << std::endl;
+}
+
+void runBenchmark() {
+    // Longer, more realistic parts than the demo builders use, so short-string optimisation does not hide the cost
+    static constexpr std::string_view kParts[] = {"ChassisFrameAssembly", "EngineBlockAssembly", "TransmissionAssembly",
+                                                  "InteriorTrimPackage", "ElectricalHarnessKit", "WheelAndTyreSet"};
+
+    benchmarkAssembly("const std::string& parts", []() {
+        LegacyProduct product;
+        for (std::string_view part : kParts) {
+            product.addPart(std::string(part)); // what passing a literal through const std::string& costs
+        }
+        return product.size();
+    });
+    benchmarkAssembly("string_view parts, reserved once", []() {
+        Product product;
+        product.reserve(std::size(kParts), totalLength(kParts));
+        for (std::string_view part : kParts) {
+            product.addPart(part);
+        }
+        return product.size();
+    });
+    benchmarkAssembly("segment list, rendered on demand", []() {
+        Product product(Product::Assembly::Segments);
+        for (std::string_view part : kParts) {
+            product.addPart(part);
+        }
+        return product.size();
+    });
+
+    // Steady-state parallel construction with pooled builders and recycled buffers
+    PartBufferPool buffers;
+    BuilderPool builders([&buffers]() {
+        return std::make_unique<ConcreteBuilder1>(Product::Assembly::Concatenated, &buffers);
+    });
+    std::atomic<std::size_t> builtBytes{0};
+    auto consume = [&buffers, &builtBytes](Product&& product) {
+        builtBytes.fetch_add(product.size(), std::memory_order_relaxed);
+        buffers.release(product.releaseBuffer());
+    };
+    const std::size_t threadCount = 4;
+    const std::size_t jobs = 2000000;
+    Director::constructMany(builders, 10000, threadCount, consume); // warm the pools
+    long before = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    Director::constructMany(builders, jobs, threadCount, consume);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "pooled Director::constructMany on " << threadCount << " threads: " << jobs / elapsed.count()
+              << " products/sec, " << static_cast<double>(heapAllocations - before) / jobs
+              << " heap allocations/product (only the worker threads themselves)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     Director director;
     
     // Construct using ConcreteBuilder1
@@ -135,5 +480,19 @@ int main() {
     Product* product2 = director.getProduct();
     product2->showProduct();
 
+    // Construct using segments, concatenated only when shown
+    director.setBuilder(std::make_unique<ConcreteBuilder1>(Product::Assembly::Segments));
+    director.construct();
+    director.getProduct()->showProduct();
+
+    // Reuse one builder for several products, each handed out by move
+    ConcreteBuilder2 reusableBuilder;
+    for (int i = 0; i < 2; ++i) {
+        reusableBuilder.buildPartA();
+        reusableBuilder.buildPartC();
+        Product product = reusableBuilder.takeProduct();
+        product.showProduct();
+    }
+
     return 0;
 }
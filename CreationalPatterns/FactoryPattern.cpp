@@ -13,11 +13,30 @@
 // This abstraction shields the client code from the details of object creation, promoting loose coupling between the client and the products.
 // Clients can request products through the Factory without needing to know the specific implementation details of each product type.
 // This flexibility allows for easy addition or modification of product types in the future, as new ConcreteProduct classes can be added without altering existing client code.
+// Instead of a chain of string comparisons, concrete products register themselves in a ProductRegistry at startup.
+// Each registered name is interned to an integer type id, name lookups go through an open-addressing hash table keyed by
+// std::string_view (so they never allocate), and creating from a type id is a plain array index.
+// For short-lived products the Factory can also build into a ProductArena (bump allocation, bulk reset) or a ProductPool
+// (per-size free lists) and hand back a ProductHandle whose deleter returns the memory to where it came from.
+// Run the program with "--bench" to compare the registry against an if-chain at 2, 100 and 5000 product types,
+// and the arena and pool against std::make_unique in products per second and heap allocations per product.
 
 
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 // Product interface
 class Product {
@@ -41,21 +60,452 @@ public:
     }
 };
 
-// Factory class
-class Factory {
+// Product Allocators
+// By default every product is its own heap allocation through std::make_unique. For short-lived products the factory
+// can instead place them in memory handed out by a ProductAllocator, and returns a ProductHandle whose deleter
+// runs the destructor and gives the memory back to the allocator that provided it.
+class ProductAllocator {
+public:
+    virtual ~ProductAllocator() = default;
+    virtual void* allocate(std::size_t size, std::size_t alignment) = 0;
+    // size and alignment are the ones the memory was allocated with
+    virtual void deallocate(void* memory, std::size_t size, std::size_t alignment) = 0;
+};
+
+struct ProductDeleter {
+    ProductAllocator* allocator = nullptr; // nullptr means the product came from plain new
+    std::size_t size = 0;
+    std::size_t alignment = 0;
+
+    void operator()(Product* product) const {
+        if (!allocator) {
+            delete product;
+            return;
+        }
+        void* memory = dynamic_cast<void*>(product); // start of the most derived object
+        product->~Product();
+        allocator->deallocate(memory, size, alignment);
+    }
+};
+
+using ProductHandle = std::unique_ptr<Product, ProductDeleter>;
+
+// Arena: bump-pointer allocation out of large chunks. Individual frees are no-ops,
+// all memory is reclaimed at once by reset() (for example at the end of a request).
+class ProductArena : public ProductAllocator {
+public:
+    explicit ProductArena(std::size_t chunkSize = 64 * 1024) : chunkSize(chunkSize) {}
+
+    // Alignment is applied to the address, so it holds beyond what the chunk memory itself is aligned to
+    void* allocate(std::size_t size, std::size_t alignment) override {
+        std::size_t start = current < chunks.size() ? alignedOffset(chunks[current], offset, alignment) : 0;
+        if (current >= chunks.size() || start + size > chunks[current].size) {
+            nextChunk(size + alignment - 1);
+            start = alignedOffset(chunks[current], 0, alignment);
+        }
+        offset = start + size;
+        return chunks[current].memory.get() + start;
+    }
+
+    void deallocate(void*, std::size_t, std::size_t) override {}
+
+    // Rewinds the arena so its chunks are reused. Every handle created from it must be destroyed first.
+    void reset() {
+        current = 0;
+        offset = 0;
+    }
+
+    long systemAllocations() const {
+        return static_cast<long>(chunks.size());
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> memory;
+        std::size_t size;
+    };
+
+    static std::size_t alignedOffset(const Chunk& chunk, std::size_t offset, std::size_t alignment) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunk.memory.get()) + offset;
+        return offset + ((alignment - address % alignment) % alignment);
+    }
+
+    void nextChunk(std::size_t size) {
+        if (!chunks.empty()) {
+            ++current;
+        }
+        // Skip kept chunks that are too small for an oversized request
+        while (current < chunks.size() && chunks[current].size < size) {
+            ++current;
+        }
+        if (current >= chunks.size()) {
+            std::size_t chunkBytes = std::max(chunkSize, size);
+            chunks.push_back({std::make_unique<unsigned char[]>(chunkBytes), chunkBytes});
+            current = chunks.size() - 1;
+        }
+        offset = 0;
+    }
+
+    std::size_t chunkSize;
+    std::vector<Chunk> chunks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+};
+
+// Pool: one free list per object size, so each product type recycles slots of exactly its own size.
+// Freed slots go back on the list and are handed out again without touching the heap.
+// A slot size is a multiple of every alignment that rounds to it, and each block is aligned to the largest power of
+// two dividing the slot size, so every slot honors the alignment it was requested with.
+class ProductPool : public ProductAllocator {
+public:
+    explicit ProductPool(std::size_t slotsPerBlock = 1024) : slotsPerBlock(slotsPerBlock) {}
+
+    void* allocate(std::size_t size, std::size_t alignment) override {
+        FreeList& list = freeLists[slotSize(size, alignment)];
+        if (!list.head) {
+            refill(list, slotSize(size, alignment));
+        }
+        Slot* slot = list.head;
+        list.head = slot->next;
+        return slot;
+    }
+
+    void deallocate(void* memory, std::size_t size, std::size_t alignment) override {
+        FreeList& list = freeLists[slotSize(size, alignment)];
+        Slot* slot = static_cast<Slot*>(memory);
+        slot->next = list.head;
+        list.head = slot;
+    }
+
+    long systemAllocations() const {
+        return static_cast<long>(blocks.size());
+    }
+
+private:
+    struct Slot {
+        Slot* next;
+    };
+
+    struct FreeList {
+        Slot* head = nullptr;
+    };
+
+    // Round up so every slot can hold the free-list link and stays suitably aligned
+    static std::size_t slotSize(std::size_t size, std::size_t alignment) {
+        std::size_t unit = std::max(alignment, alignof(std::max_align_t));
+        return (std::max(size, sizeof(Slot)) + unit - 1) & ~(unit - 1);
+    }
+
+    void refill(FreeList& list, std::size_t size) {
+        std::size_t blockAlignment = size & (~size + 1);
+        blocks.push_back(std::make_unique<unsigned char[]>(size * slotsPerBlock + blockAlignment - 1));
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(blocks.back().get());
+        unsigned char* block = blocks.back().get() + (blockAlignment - address % blockAlignment) % blockAlignment;
+        for (std::size_t i = slotsPerBlock; i-- > 0;) {
+            Slot* slot = reinterpret_cast<Slot*>(block + i * size);
+            slot->next = list.head;
+            list.head = slot;
+        }
+    }
+
+    std::size_t slotsPerBlock;
+    std::unordered_map<std::size_t, FreeList> freeLists;
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+};
+
+// Type-erased recipe for one product type: heap creation plus placement construction into allocator memory
+struct ProductType {
+    std::unique_ptr<Product> (*create)();
+    Product* (*construct)(void* memory);
+    std::size_t size;
+    std::size_t alignment;
+
+    template <typename T>
+    static ProductType of() {
+        return {[]() -> std::unique_ptr<Product> { return std::make_unique<T>(); },
+                [](void* memory) -> Product* { return new (memory) T(); },
+                sizeof(T), alignof(T)};
+    }
+};
+
+// Product Registry
+// Maps product names to interned integer type ids and type ids to their ProductType.
+class ProductRegistry {
 public:
-    static std::unique_ptr<Product> createProduct(const std::string& type) {
-        if (type == "Product1") {
-            return std::make_unique<ConcreteProduct1>();
-        } else if (type == "Product2") {
-            return std::make_unique<ConcreteProduct2>();
+
+    // Registry used by Factory, built up by the self-registering products below
+    static ProductRegistry& global() {
+        static ProductRegistry registry;
+        return registry;
+    }
+
+    // Returns the interned type id, registering the name the first time it is seen
+    int registerProduct(std::string_view name, const ProductType& type) {
+        int existing = typeId(name);
+        if (existing >= 0) {
+            types[existing] = type;
+            return existing;
+        }
+        names.emplace_back(name);
+        types.push_back(type);
+        int id = static_cast<int>(types.size()) - 1;
+        // Keep the table at most half full so probe sequences stay short
+        if (types.size() * 2 > slots.size()) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
         } else {
-            return nullptr; // Handle unknown types gracefully
+            insertSlot(id);
+        }
+        return id;
+    }
+
+    // Returns -1 for unknown names
+    int typeId(std::string_view name) const {
+        if (slots.empty()) {
+            return -1;
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hash(name) & mask;; i = (i + 1) & mask) {
+            int id = slots[i];
+            if (id < 0) {
+                return -1;
+            }
+            if (names[id] == name) {
+                return id;
+            }
+        }
+    }
+
+    std::unique_ptr<Product> create(int id) const {
+        if (id < 0 || id >= static_cast<int>(types.size())) {
+            return nullptr;
+        }
+        return types[id].create();
+    }
+
+    std::unique_ptr<Product> create(std::string_view name) const {
+        return create(typeId(name));
+    }
+
+    // Builds the product in memory taken from the allocator, the handle returns it there on destruction
+    ProductHandle create(int id, ProductAllocator& allocator) const {
+        if (id < 0 || id >= static_cast<int>(types.size())) {
+            return ProductHandle(nullptr, ProductDeleter{});
+        }
+        const ProductType& type = types[id];
+        void* memory = allocator.allocate(type.size, type.alignment);
+        return ProductHandle(type.construct(memory), ProductDeleter{&allocator, type.size, type.alignment});
+    }
+
+    ProductHandle create(std::string_view name, ProductAllocator& allocator) const {
+        return create(typeId(name), allocator);
+    }
+
+private:
+    // FNV-1a, cheap and good enough for short type names
+    static std::size_t hash(std::string_view name) {
+        std::size_t h = 14695981039346656037ull;
+        for (char c : name) {
+            h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    void insertSlot(int id) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hash(names[id]) & mask;
+        while (slots[i] >= 0) {
+            i = (i + 1) & mask;
         }
+        slots[i] = id;
+    }
+
+    void rehash(std::size_t slotCount) {
+        slots.assign(slotCount, -1);
+        for (int id = 0; id < static_cast<int>(types.size()); ++id) {
+            insertSlot(id);
+        }
+    }
+
+    std::deque<std::string> names; // deque keeps the interned strings at stable addresses
+    std::vector<ProductType> types;
+    std::vector<int> slots;        // open-addressing table of type ids, -1 marks an empty slot
+};
+
+// Self-registration: each concrete product adds itself to the global registry during static initialization
+template <typename T>
+int registerProduct(std::string_view name) {
+    return ProductRegistry::global().registerProduct(name, ProductType::of<T>());
+}
+
+const int ConcreteProduct1Id = registerProduct<ConcreteProduct1>("Product1");
+const int ConcreteProduct2Id = registerProduct<ConcreteProduct2>("Product2");
+
+// Factory class
+class Factory {
+public:
+    // Accepts std::string, string literals and std::string_view without allocating
+    static std::unique_ptr<Product> createProduct(std::string_view type) {
+        return ProductRegistry::global().create(type); // nullptr for unknown types
+    }
+
+    // Fastest path when the caller already holds an interned type id
+    static std::unique_ptr<Product> createProduct(int typeId) {
+        return ProductRegistry::global().create(typeId);
+    }
+
+    // Arena or pool backed creation for short-lived products
+    static ProductHandle createProduct(std::string_view type, ProductAllocator& allocator) {
+        return ProductRegistry::global().create(type, allocator);
+    }
+
+    static ProductHandle createProduct(int typeId, ProductAllocator& allocator) {
+        return ProductRegistry::global().create(typeId, allocator);
+    }
+};
+
+// Benchmark: the old if-chain is modelled as a linear scan of string comparisons, which is what it compiles to
+class BenchProduct : public Product {
+public:
+    void printInfo() override {
+        std::cout << "This is BenchProduct" << std::endl;
     }
 };
 
-int main() {
+std::unique_ptr<Product> createByIfChain(const std::vector<std::string>& typeNames, const std::string& type) {
+    for (const auto& name : typeNames) {
+        if (type == name) {
+            return std::make_unique<BenchProduct>();
+        }
+    }
+    return nullptr;
+}
+
+void runLookupBenchmark() {
+    const int lookups = 500000;
+    for (int typeCount : {2, 100, 5000}) {
+        std::vector<std::string> typeNames;
+        ProductRegistry registry;
+        for (int i = 0; i < typeCount; ++i) {
+            typeNames.push_back("Product" + std::to_string(i));
+            registry.registerProduct(typeNames.back(), ProductType::of<BenchProduct>());
+        }
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> pick(0, typeCount - 1);
+        std::vector<std::string> queries;
+        for (int i = 0; i < 4096; ++i) {
+            queries.push_back(typeNames[pick(rng)]);
+        }
+
+        long created = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            created += createByIfChain(typeNames, queries[i & 4095]) != nullptr;
+        }
+        std::chrono::duration<double> ifChain = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            created += registry.create(std::string_view(queries[i & 4095])) != nullptr;
+        }
+        std::chrono::duration<double> byName = std::chrono::steady_clock::now() - start;
+
+        std::vector<int> queryIds;
+        for (const auto& query : queries) {
+            queryIds.push_back(registry.typeId(query));
+        }
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            created += registry.create(queryIds[i & 4095]) != nullptr;
+        }
+        std::chrono::duration<double> byId = std::chrono::steady_clock::now() - start;
+
+        std::cout << typeCount << " types: if-chain " << lookups / ifChain.count()
+                  << " creates/sec, registry by name " << lookups / byName.count()
+                  << " creates/sec, registry by id " << lookups / byId.count()
+                  << " creates/sec (" << created << " created)" << std::endl;
+    }
+}
+
+// Counts every global operator new so the benchmark can report heap allocations.
+// The replacements are kept out of line so GCC does not mistake the inlined malloc/free for mismatched allocations.
+std::atomic<long> heapAllocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// Simulates requests that each create and discard a batch of short-lived products
+void runAllocationBenchmark() {
+    const int requests = 2000;
+    const int productsPerRequest = 1000;
+    const double totalProducts = static_cast<double>(requests) * productsPerRequest;
+    std::vector<ProductHandle> live;
+    live.reserve(productsPerRequest);
+
+    auto report = [&](const char* label, long allocations, std::chrono::duration<double> elapsed) {
+        std::cout << label << ": " << totalProducts / elapsed.count() << " products/sec, "
+                  << allocations / totalProducts << " heap allocations/product" << std::endl;
+    };
+
+    long before = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < requests; ++r) {
+        std::vector<std::unique_ptr<Product>> products;
+        products.reserve(productsPerRequest);
+        for (int i = 0; i < productsPerRequest; ++i) {
+            products.push_back(Factory::createProduct(i & 1 ? ConcreteProduct1Id : ConcreteProduct2Id));
+        }
+    }
+    // Subtract the per-request vector so only product allocations are counted
+    report("make_unique", heapAllocations - before - requests, std::chrono::steady_clock::now() - start);
+
+    ProductPool pool;
+    before = heapAllocations;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < requests; ++r) {
+        for (int i = 0; i < productsPerRequest; ++i) {
+            live.push_back(Factory::createProduct(i & 1 ? ConcreteProduct1Id : ConcreteProduct2Id, pool));
+        }
+        live.clear();
+    }
+    report("pool", heapAllocations - before, std::chrono::steady_clock::now() - start);
+
+    ProductArena arena;
+    before = heapAllocations;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < requests; ++r) {
+        for (int i = 0; i < productsPerRequest; ++i) {
+            live.push_back(Factory::createProduct(i & 1 ? ConcreteProduct1Id : ConcreteProduct2Id, arena));
+        }
+        live.clear();
+        arena.reset(); // end of request: the whole arena is recycled in one step
+    }
+    report("arena", heapAllocations - before, std::chrono::steady_clock::now() - start);
+}
+
+void runBenchmark() {
+    runLookupBenchmark();
+    runAllocationBenchmark();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     // Create products using the Factory
     std::unique_ptr<Product> product1 = Factory::createProduct("Product1");
     std::unique_ptr<Product> product2 = Factory::createProduct("Product2");
@@ -69,5 +519,15 @@ int main() {
         product2->printInfo();
     }
 
+    // Create short-lived products in an arena and release them all at the end of the request
+    ProductArena arena;
+    {
+        ProductHandle pooledProduct1 = Factory::createProduct("Product1", arena);
+        ProductHandle pooledProduct2 = Factory::createProduct("Product2", arena);
+        pooledProduct1->printInfo();
+        pooledProduct2->printInfo();
+    }
+    arena.reset();
+
     return 0;
 }
@@ -9,14 +9,168 @@
 
 // In this example, The Prototype class defines the interface for cloning itself and showing information about the cloned object. Concrete classes derived from Prototype implement these methods.
 // ConcretePrototype class is a concrete implementation of Prototype. It holds a unique field 'prototype_field_' and implements the clone method by creating a new instance of itself and copying its field value.
+// When many copies are needed at once, cloneN(n, arena) builds all n copies side by side in a PrototypeArena instead of
+// one heap allocation and one virtual call per copy. For prototypes whose type is trivially copyable (plain data such as
+// ParticlePrototype below) the copies are made with a block memcpy that doubles the filled range on each step.
+// Polymorphic prototypes can never be trivially copyable because of their vtable, so they are copy-constructed in place.
+// PrototypeRegistry keeps keyed prototypes with bounded pools of ready-made clones that a background thread tops up,
+// and reports hit rate, refill lag and p99 acquire latency so the pools can be sized.
+// Run the program with "--bench" to compare clone() with bulk cloning at 1K, 100K and 10M copies, and to see how
+// pool capacity affects the registry's hit rate and acquire latency.
 
 
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <new>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stdexcept>
+
+// Prototype Arena
+// Bump allocator for bulk clones. reset() destroys every copy made in it and reuses the memory.
+class PrototypeArena {
+public:
+    explicit PrototypeArena(std::size_t chunkSize = 1 << 20) : chunkSize(chunkSize) {}
+
+    PrototypeArena(const PrototypeArena&) = delete;
+    PrototypeArena& operator=(const PrototypeArena&) = delete;
+
+    ~PrototypeArena() {
+        reset();
+    }
+
+    // Alignment is applied to the address, so it holds beyond what the chunk memory itself is aligned to
+    void* allocate(std::size_t size, std::size_t alignment) {
+        if (current < chunks.size()) {
+            if (void* memory = fit(chunks[current], size, alignment)) {
+                return memory;
+            }
+        }
+        // Move on to the next kept chunk, or add one, until the request fits
+        for (++current; current < chunks.size(); ++current) {
+            offset = 0;
+            if (void* memory = fit(chunks[current], size, alignment)) {
+                return memory;
+            }
+        }
+        std::size_t chunkBytes = std::max(chunkSize, size + alignment - 1);
+        chunks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[chunkBytes]), chunkBytes}); // left uninitialised
+        current = chunks.size() - 1;
+        offset = 0;
+        return fit(chunks[current], size, alignment);
+    }
+
+    // Remembers how to destroy a block of copies, trivially destructible types skip this entirely
+    template <typename T>
+    void registerBlock(T* first, std::size_t count) {
+        if (!std::is_trivially_destructible<T>::value) {
+            blocks.push_back({first, count, [](void* block, std::size_t n) {
+                T* objects = static_cast<T*>(block);
+                for (std::size_t i = 0; i < n; ++i) {
+                    objects[i].~T();
+                }
+            }});
+        }
+    }
+
+    void reset() {
+        for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+            it->destroy(it->first, it->count);
+        }
+        blocks.clear();
+        current = 0;
+        offset = 0;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> memory;
+        std::size_t size;
+    };
+
+    struct Block {
+        void* first;
+        std::size_t count;
+        void (*destroy)(void*, std::size_t);
+    };
+
+    void* fit(const Chunk& chunk, std::size_t size, std::size_t alignment) {
+        void* memory = chunk.memory.get() + offset;
+        std::size_t space = chunk.size - offset;
+        if (!std::align(alignment, size, memory, space)) {
+            return nullptr;
+        }
+        offset = chunk.size - space + size;
+        return memory;
+    }
+
+    std::size_t chunkSize;
+    std::vector<Chunk> chunks;
+    std::vector<Block> blocks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+};
+
+// Makes n contiguous copies of prototype inside the arena
+template <typename T>
+T* cloneN(const T& prototype, std::size_t n, PrototypeArena& arena) {
+    T* copies = static_cast<T*>(arena.allocate(sizeof(T) * std::max<std::size_t>(n, 1), alignof(T)));
+    if (n == 0) {
+        return copies;
+    }
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        // Block-copy fast path: copy once, then keep doubling the already filled range
+        std::memcpy(static_cast<void*>(copies), &prototype, sizeof(T));
+        std::size_t filled = 1;
+        while (filled < n) {
+            std::size_t count = std::min(filled, n - filled);
+            std::memcpy(static_cast<void*>(copies + filled), copies, count * sizeof(T));
+            filled += count;
+        }
+    } else {
+        for (std::size_t i = 0; i < n; ++i) {
+            new (copies + i) T(prototype);
+        }
+    }
+    arena.registerBlock(copies, n);
+    return copies;
+}
+
+class Prototype;
+
+// View over n copies of one concrete prototype laid out contiguously
+class PrototypeRange {
+public:
+    PrototypeRange(Prototype* first, std::size_t stride, std::size_t count) : first(first), stride(stride), count(count) {}
+
+    std::size_t size() const {
+        return count;
+    }
+
+    Prototype& operator[](std::size_t index) const {
+        return *reinterpret_cast<Prototype*>(reinterpret_cast<unsigned char*>(first) + index * stride);
+    }
+
+private:
+    Prototype* first;
+    std::size_t stride;
+    std::size_t count;
+};
 
 class Prototype {
 public:
     virtual std::unique_ptr<Prototype> clone() const = 0;
+    // n copies in one go, stored contiguously in the arena
+    virtual PrototypeRange cloneN(std::size_t n, PrototypeArena& arena) const = 0;
     virtual void showInfo() const = 0;
     virtual ~Prototype() = default;
 };
@@ -33,12 +187,307 @@ public:
         return std::make_unique<ConcretePrototype>(*this);
     }
 
+    PrototypeRange cloneN(std::size_t n, PrototypeArena& arena) const override {
+        ConcretePrototype* copies = ::cloneN(*this, n, arena);
+        return PrototypeRange(copies, sizeof(ConcretePrototype), n);
+    }
+
     void showInfo() const override {
         std::cout << "Prototype with field: " << m_prototype_field_ << std::endl;
     }
+
+    int field() const {
+        return m_prototype_field_;
+    }
+};
+
+// Plain-data prototype, trivially copyable, so bulk cloning takes the memcpy fast path
+struct ParticlePrototype {
+    float position[3];
+    float velocity[3];
+    int kind;
+
+    void showInfo() const {
+        std::cout << "Particle of kind " << kind << " at (" << position[0] << ", " << position[1] << ", " << position[2] << ")" << std::endl;
+    }
 };
 
-int main() {
+static_assert(std::is_trivially_copyable<ParticlePrototype>::value, "ParticlePrototype must stay trivially copyable");
+
+// Prototype whose copy is expensive: it carries a large payload that every clone has to duplicate
+class DocumentPrototype : public Prototype {
+private:
+    std::string title_;
+    std::vector<int> payload_;
+
+public:
+    DocumentPrototype(const std::string& title, std::size_t payloadSize) : title_(title), payload_(payloadSize, 42) {}
+
+    std::unique_ptr<Prototype> clone() const override {
+        return std::make_unique<DocumentPrototype>(*this);
+    }
+
+    PrototypeRange cloneN(std::size_t n, PrototypeArena& arena) const override {
+        DocumentPrototype* copies = ::cloneN(*this, n, arena);
+        return PrototypeRange(copies, sizeof(DocumentPrototype), n);
+    }
+
+    void showInfo() const override {
+        std::cout << "Document '" << title_ << "' with " << payload_.size() << " payload entries" << std::endl;
+    }
+};
+
+// Prototype Registry
+// Keeps every registered prototype under a key together with a bounded pool of ready-made clones.
+// acquire() hands out a pooled clone when one is ready and falls back to cloning synchronously when the pool is empty.
+// Whenever a pool drops below its low-water mark, a background thread refills it up to capacity,
+// so the copy cost is paid off the request path.
+class PrototypeRegistry {
+public:
+    struct Stats {
+        long hits = 0;
+        long misses = 0;
+        double hitRate = 0;
+        double averageRefillLagMs = 0; // time from dropping below low water until back at capacity
+        double maxRefillLagMs = 0;
+        double p99AcquireMicros = 0;
+    };
+
+    PrototypeRegistry() : refiller([this]() { refillLoop(); }) {}
+
+    PrototypeRegistry(const PrototypeRegistry&) = delete;
+    PrototypeRegistry& operator=(const PrototypeRegistry&) = delete;
+
+    ~PrototypeRegistry() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        refiller.join();
+    }
+
+    // Registers a prototype and asks the background thread to pre-warm its pool. Keys can be added only once:
+    // the refiller and acquire() keep using an entry without the lock, so an entry is never replaced or freed early.
+    void addPrototype(const std::string& key, std::unique_ptr<Prototype> prototype, std::size_t capacity, std::size_t lowWater) {
+        std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+        entry->prototype = std::move(prototype);
+        entry->capacity = capacity;
+        entry->lowWater = std::min(lowWater, capacity);
+        std::lock_guard<std::mutex> lock(mtx);
+        if (entries.count(key)) {
+            throw std::runtime_error("Prototype already registered: " + key);
+        }
+        Entry& added = *entry;
+        entries.emplace(key, std::move(entry));
+        requestRefill(added);
+    }
+
+    // Blocks until the key's pool is full and no refill is pending
+    void waitUntilWarm(const std::string& key) {
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return;
+        }
+        const Entry& entry = *it->second;
+        refilled.wait(lock, [&entry]() { return !entry.refillPending; });
+    }
+
+    // Returns nullptr for unknown keys
+    std::unique_ptr<Prototype> acquire(const std::string& key) {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        Entry& entry = *it->second;
+        std::unique_ptr<Prototype> clone;
+        if (!entry.ready.empty()) {
+            clone = std::move(entry.ready.back());
+            entry.ready.pop_back();
+            ++entry.hits;
+        } else {
+            ++entry.misses;
+        }
+        if (entry.ready.size() < entry.lowWater) {
+            requestRefill(entry);
+        }
+        if (!clone) {
+            // Pool ran dry, pay for the copy right here. The prototype itself is never modified, so this is safe unlocked.
+            lock.unlock();
+            clone = entry.prototype->clone();
+            lock.lock();
+        }
+        recordLatency(entry, std::chrono::steady_clock::now() - start);
+        return clone;
+    }
+
+    Stats stats(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Stats result;
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return result;
+        }
+        const Entry& entry = *it->second;
+        result.hits = entry.hits;
+        result.misses = entry.misses;
+        long total = entry.hits + entry.misses;
+        result.hitRate = total ? static_cast<double>(entry.hits) / total : 0;
+        result.averageRefillLagMs = entry.refills ? entry.totalRefillLagMs / entry.refills : 0;
+        result.maxRefillLagMs = entry.maxRefillLagMs;
+        std::vector<double> samples(entry.latencyMicros.begin(), entry.latencyMicros.end());
+        if (!samples.empty()) {
+            std::size_t rank = samples.size() * 99 / 100;
+            std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+            result.p99AcquireMicros = samples[rank];
+        }
+        return result;
+    }
+
+    void printStats(const std::string& key) {
+        Stats s = stats(key);
+        std::cout << key << ": hit rate " << s.hitRate * 100 << "% (" << s.hits << " hits, " << s.misses << " misses), refill lag avg "
+                  << s.averageRefillLagMs << " ms / max " << s.maxRefillLagMs << " ms, p99 acquire " << s.p99AcquireMicros << " us" << std::endl;
+    }
+
+private:
+    static constexpr std::size_t kLatencySamples = 4096; // most recent acquires kept for the percentile
+
+    struct Entry {
+        std::unique_ptr<Prototype> prototype;
+        std::vector<std::unique_ptr<Prototype>> ready;
+        std::size_t capacity = 0;
+        std::size_t lowWater = 0;
+        bool refillPending = false;
+        std::chrono::steady_clock::time_point lowSince;
+        long hits = 0;
+        long misses = 0;
+        long refills = 0;
+        double totalRefillLagMs = 0;
+        double maxRefillLagMs = 0;
+        std::vector<double> latencyMicros;
+        std::size_t nextSample = 0;
+    };
+
+    // Caller holds mtx
+    void requestRefill(Entry& entry) {
+        if (entry.refillPending || entry.ready.size() >= entry.capacity) {
+            return;
+        }
+        entry.refillPending = true;
+        entry.lowSince = std::chrono::steady_clock::now();
+        pending.push_back(&entry);
+        cv.notify_one();
+    }
+
+    // Caller holds mtx
+    void recordLatency(Entry& entry, std::chrono::steady_clock::duration elapsed) {
+        double micros = std::chrono::duration<double, std::micro>(elapsed).count();
+        if (entry.latencyMicros.size() < kLatencySamples) {
+            entry.latencyMicros.push_back(micros);
+        } else {
+            entry.latencyMicros[entry.nextSample] = micros;
+            entry.nextSample = (entry.nextSample + 1) % kLatencySamples;
+        }
+    }
+
+    void refillLoop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (stopping) {
+                return;
+            }
+            Entry& entry = *pending.front();
+            pending.pop_front();
+            while (!stopping && entry.ready.size() < entry.capacity) {
+                // Clone without holding the lock so acquire() is never blocked behind a copy
+                lock.unlock();
+                std::unique_ptr<Prototype> clone = entry.prototype->clone();
+                lock.lock();
+                entry.ready.push_back(std::move(clone));
+            }
+            double lagMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - entry.lowSince).count();
+            entry.totalRefillLagMs += lagMs;
+            entry.maxRefillLagMs = std::max(entry.maxRefillLagMs, lagMs);
+            ++entry.refills;
+            entry.refillPending = false;
+            refilled.notify_all();
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::condition_variable refilled; // signalled whenever a refill finishes
+    bool stopping = false;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries; // entries never move, the refiller keeps raw pointers
+    std::deque<Entry*> pending;
+    std::thread refiller; // declared last so everything it uses exists before it starts
+};
+
+// Benchmark: one clone() per copy against bulk cloning into an arena
+void runBenchmark() {
+    ConcretePrototype prototype(100);
+    ParticlePrototype particle{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.0f}, 7};
+    PrototypeArena arena;
+    for (std::size_t copies : {std::size_t(1000), std::size_t(100000), std::size_t(10000000)}) {
+        long checksum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::unique_ptr<Prototype>> clones;
+            clones.reserve(copies);
+            for (std::size_t i = 0; i < copies; ++i) {
+                clones.push_back(prototype.clone());
+            }
+            checksum += static_cast<long>(clones.size());
+        }
+        std::chrono::duration<double, std::milli> perObject = std::chrono::steady_clock::now() - start;
+
+        // Untimed warm-up so the arena already owns its chunks, as it would in steady state
+        prototype.cloneN(copies, arena);
+        cloneN(particle, copies, arena);
+        arena.reset();
+
+        start = std::chrono::steady_clock::now();
+        PrototypeRange range = prototype.cloneN(copies, arena);
+        checksum += static_cast<ConcretePrototype&>(range[copies - 1]).field();
+        arena.reset();
+        std::chrono::duration<double, std::milli> bulk = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        ParticlePrototype* particles = cloneN(particle, copies, arena);
+        checksum += particles[copies - 1].kind;
+        arena.reset();
+        std::chrono::duration<double, std::milli> blockCopy = std::chrono::steady_clock::now() - start;
+
+        std::cout << copies << " copies: clone() " << perObject.count() << " ms, cloneN " << bulk.count()
+                  << " ms, trivially copyable cloneN " << blockCopy.count() << " ms (checksum " << checksum << ")" << std::endl;
+    }
+
+    // Registry pools of different sizes serving a steady stream of requests for an expensive prototype
+    for (std::size_t capacity : {std::size_t(0), std::size_t(8), std::size_t(64)}) {
+        PrototypeRegistry registry;
+        std::string key = "document-pool-" + std::to_string(capacity);
+        registry.addPrototype(key, std::make_unique<DocumentPrototype>("Report", 200000), capacity, capacity / 2);
+        registry.waitUntilWarm(key); // let the pool pre-warm before traffic arrives
+        for (int request = 0; request < 2000; ++request) {
+            std::unique_ptr<Prototype> document = registry.acquire(key);
+            std::this_thread::sleep_for(std::chrono::microseconds(50)); // the rest of the request
+        }
+        registry.printStats(key);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     // Create a prototype object
     ConcretePrototype prototype(100);
 
@@ -54,5 +503,28 @@ int main() {
     clone->showInfo();
     std::cout << " Address of cloned prototype: " << clone.get() << std::endl;
 
+    // Clone in bulk into an arena, the copies sit next to each other
+    PrototypeArena arena;
+    PrototypeRange copies = prototype.cloneN(3, arena);
+    for (std::size_t i = 0; i < copies.size(); ++i) {
+        std::cout << "Bulk clone " << i << " at " << &copies[i] << ": ";
+        copies[i].showInfo();
+    }
+
+    // Trivially copyable prototypes are block-copied
+    ParticlePrototype particle{{1.0f, 2.0f, 3.0f}, {0.5f, 0.5f, 0.0f}, 7};
+    ParticlePrototype* particles = cloneN(particle, 2, arena);
+    particles[1].showInfo();
+
+    // Registry with a pre-warmed pool of clones
+    PrototypeRegistry registry;
+    registry.addPrototype("report", std::make_unique<DocumentPrototype>("Report", 1000), 4, 2);
+    registry.waitUntilWarm("report");
+    for (int i = 0; i < 3; ++i) {
+        std::unique_ptr<Prototype> document = registry.acquire("report");
+        document->showInfo();
+    }
+    registry.printStats("report");
+
     return 0;
-}
\ No newline at end of file
+}
@@ -10,24 +10,55 @@
 // In this example, the Singleton design pattern is implemented to ensure that the class Singleton has only one instance throughout the program execution. 
 // This is achieved by providing a static member function, getInstance(), which returns a reference to the single instance of the Singleton class. If the instance doesn't exist, it is created; otherwise, the existing instance is returned.
 // Additionally, the copy constructor and assignment operator are deleted to prevent cloning of the Singleton instance, ensuring its uniqueness.
+// First-use construction goes through std::call_once, so several threads racing on getInstance() still build exactly one instance.
+// getInstance() keeps logging every access for the demo, while getInstanceFast() is the print-free accessor for hot paths:
+// once the instance exists it costs a single acquire load of an atomic pointer.
+// SingletonRegistry extends the idea to many services with declared dependencies, built in parallel and in dependency order at startup.
+// Run the program with "--bench" to measure accesses per second from 1 up to 64 threads.
 
 
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <queue>
+#include <condition_variable>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
 
 class Singleton {
 public:
     // Static member function to access the instance
     static Singleton& getInstance() {
         // Create the instance if it doesn't exist
-        if (!instance) {
-            instance.reset(new Singleton());
+        bool created = false;
+        Singleton& singleton = createOnce(created);
+        if (created) {
             std::cout << "Created new Instance of object." << std::endl;
         }
         else {
             std::cout << "Returning already existing Instance of object." << std::endl;
         }
-        return *instance;
+        return singleton;
+    }
+
+    // Print-free accessor for hot paths, after first use this is just an atomic pointer read
+    static Singleton& getInstanceFast() {
+        Singleton* singleton = fastInstance.load(std::memory_order_acquire);
+        if (singleton) {
+            return *singleton;
+        }
+        bool created = false;
+        return createOnce(created);
     }
     
     // Delete copy constructor and assignment operator to prevent cloning
@@ -44,14 +75,290 @@ private:
     // Private constructor to prevent instantiation
     Singleton() {}
 
+    // Builds the instance exactly once even if many threads get here at the same time
+    static Singleton& createOnce(bool& created) {
+        std::call_once(initFlag, [&created]() {
+            instance.reset(new Singleton());
+            fastInstance.store(instance.get(), std::memory_order_release);
+            created = true;
+        });
+        return *instance;
+    }
+
     // Private static pointer to the single instance
     static std::unique_ptr<Singleton> instance;
+    // Raw copy of the pointer published once construction has finished
+    static std::atomic<Singleton*> fastInstance;
+    static std::once_flag initFlag;
 };
 
 // Initialize the static instance pointer to nullptr
 std::unique_ptr<Singleton> Singleton::instance = nullptr;
+std::atomic<Singleton*> Singleton::fastInstance{nullptr};
+std::once_flag Singleton::initFlag;
+
+// Singleton Registry
+// Processes usually hold many global services, each built lazily the first time someone asks for it.
+// The registry lets every service declare the services it depends on, so startAll() can build independent
+// services in parallel on a small pool of threads while still respecting the dependency order.
+// Anything not built at startup is still created lazily (dependencies first) the first time get() is called.
+// A registration that would close a dependency cycle is rejected, so neither startup nor a lazy get() can loop.
+class SingletonRegistry {
+public:
+    using Factory = std::function<std::shared_ptr<void>()>;
+    using WarmUp = std::function<void(void*)>;
+
+    void registerService(const std::string& name, const std::vector<std::string>& dependencies,
+                         Factory factory, WarmUp warmUp = nullptr) {
+        // Dependencies may be registered later; whichever registration closes a cycle is the one that sees it
+        std::unordered_set<std::string> visited;
+        for (const auto& dependency : dependencies) {
+            if (reaches(dependency, name, visited)) {
+                throw std::runtime_error("SingletonRegistry: " + name + " -> " + dependency +
+                                         " would close a dependency cycle");
+            }
+        }
+        std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+        entry->name = name;
+        entry->dependencies = dependencies;
+        entry->factory = std::move(factory);
+        entry->warmUp = std::move(warmUp);
+        entries[name] = std::move(entry);
+    }
+
+    // Returns the service, building it (and its dependencies) on first use if startup has not done it yet
+    template <typename T>
+    T& get(const std::string& name) {
+        return *static_cast<T*>(initialize(lookup(name)));
+    }
+
+    // Builds every registered service on threadCount workers in topological order.
+    // When warm is true each service's warm-up hook runs right after it is constructed.
+    // If a factory or warm-up hook throws, no further services are started and the first exception is rethrown here
+    // once the workers have stopped.
+    void startAll(std::size_t threadCount, bool warm) {
+        std::unordered_map<Entry*, int> pendingDeps;
+        std::unordered_map<Entry*, std::vector<Entry*>> dependents;
+        std::queue<Entry*> ready;
+        for (auto& item : entries) {
+            Entry* entry = item.second.get();
+            pendingDeps[entry] = static_cast<int>(entry->dependencies.size());
+            for (const auto& dependency : entry->dependencies) {
+                dependents[&lookup(dependency)].push_back(entry);
+            }
+            if (entry->dependencies.empty()) {
+                ready.push(entry);
+            }
+        }
+
+        std::mutex queueMutex;
+        std::condition_variable queueCv;
+        std::size_t finished = 0;
+        std::size_t running = 0;
+        std::exception_ptr failure;
+        auto startTime = std::chrono::steady_clock::now();
+
+        auto worker = [&]() {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            while (true) {
+                queueCv.wait(lock, [&]() { return !ready.empty() || running == 0 || failure; });
+                if (ready.empty() || failure) {
+                    // Done, or a service failed and the rest is abandoned
+                    queueCv.notify_all();
+                    return;
+                }
+                Entry* entry = ready.front();
+                ready.pop();
+                ++running;
+                lock.unlock();
+
+                try {
+                    initialize(*entry);
+                    if (warm && entry->warmUp) {
+                        entry->warmUp(entry->instance.get());
+                    }
+                } catch (...) {
+                    lock.lock();
+                    --running;
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    queueCv.notify_all();
+                    continue;
+                }
+
+                lock.lock();
+                --running;
+                ++finished;
+                for (Entry* dependent : dependents[entry]) {
+                    if (--pendingDeps[dependent] == 0) {
+                        ready.push(dependent);
+                    }
+                }
+                queueCv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < std::max<std::size_t>(threadCount, 1); ++i) {
+            workers.emplace_back(worker);
+        }
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        wallTime = std::chrono::steady_clock::now() - startTime;
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        if (finished != entries.size()) {
+            throw std::runtime_error("SingletonRegistry: dependency cycle between services");
+        }
+    }
+
+    // Per-service construction time plus the longest dependency chain (the critical path)
+    void printReport() {
+        std::chrono::duration<double, std::milli> serialSum{0};
+        std::chrono::duration<double, std::milli> criticalPath{0};
+        for (auto& item : entries) {
+            Entry& entry = *item.second;
+            std::cout << "  " << entry.name << ": " << entry.initTime.count() << " ms" << std::endl;
+            serialSum += entry.initTime;
+            criticalPath = std::max(criticalPath, criticalPathOf(entry));
+        }
+        std::cout << "Serial sum of constructors: " << serialSum.count() << " ms" << std::endl;
+        std::cout << "Critical path: " << criticalPath.count() << " ms" << std::endl;
+        std::cout << "Parallel startup wall time: "
+                  << std::chrono::duration<double, std::milli>(wallTime).count() << " ms" << std::endl;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        std::vector<std::string> dependencies;
+        Factory factory;
+        WarmUp warmUp;
+        std::shared_ptr<void> instance;
+        std::once_flag initFlag;
+        std::chrono::duration<double, std::milli> initTime{0};
+    };
+
+    Entry& lookup(const std::string& name) {
+        auto it = entries.find(name);
+        if (it == entries.end()) {
+            throw std::runtime_error("SingletonRegistry: unknown service " + name);
+        }
+        return *it->second;
+    }
+
+    void* initialize(Entry& entry) {
+        std::call_once(entry.initFlag, [this, &entry]() {
+            for (const auto& dependency : entry.dependencies) {
+                initialize(lookup(dependency));
+            }
+            auto start = std::chrono::steady_clock::now();
+            entry.instance = entry.factory();
+            entry.initTime = std::chrono::steady_clock::now() - start;
+        });
+        return entry.instance.get();
+    }
+
+    // True when target is service itself or one of its registered, direct or indirect, dependencies
+    bool reaches(const std::string& service, const std::string& target,
+                 std::unordered_set<std::string>& visited) const {
+        if (service == target) {
+            return true;
+        }
+        if (!visited.insert(service).second) {
+            return false;
+        }
+        auto it = entries.find(service);
+        if (it == entries.end()) {
+            return false;
+        }
+        for (const auto& dependency : it->second->dependencies) {
+            if (reaches(dependency, target, visited)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> criticalPathOf(Entry& entry) {
+        std::chrono::duration<double, std::milli> longestDependency{0};
+        for (const auto& dependency : entry.dependencies) {
+            longestDependency = std::max(longestDependency, criticalPathOf(lookup(dependency)));
+        }
+        return entry.initTime + longestDependency;
+    }
+
+    // Entries are never moved once registered, so workers can hold raw pointers to them
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+    std::chrono::steady_clock::duration wallTime{0};
+};
+
+// Sample service standing in for something slow to construct (config parsing, connection pools ...)
+class Service {
+public:
+    Service(const std::string& name, int constructionMillis) : name_(name) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(constructionMillis));
+    }
+
+    void warmUp() {
+        warmed_ = true;
+    }
+
+    void showMessage() const {
+        std::cout << "Hello, I am the " << name_ << " service" << (warmed_ ? " (warmed)" : "") << std::endl;
+    }
+
+private:
+    std::string name_;
+    bool warmed_ = false;
+};
+
+void registerSampleService(SingletonRegistry& registry, const std::string& name,
+                           const std::vector<std::string>& dependencies, int constructionMillis) {
+    registry.registerService(
+        name, dependencies,
+        [name, constructionMillis]() { return std::make_shared<Service>(name, constructionMillis); },
+        [](void* service) { static_cast<Service*>(service)->warmUp(); });
+}
+
+// Benchmark: every thread hammers getInstanceFast() and we report total accesses per second
+void runBenchmark() {
+    const long accessesPerThread = 10000000;
+    for (int threadCount = 1; threadCount <= 64; threadCount *= 2) {
+        std::atomic<long> checksum{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&checksum, accessesPerThread]() {
+                long local = 0;
+                for (long i = 0; i < accessesPerThread; ++i) {
+                    // Fold the address in so the compiler cannot drop the loop
+                    local += reinterpret_cast<std::uintptr_t>(&Singleton::getInstanceFast()) & 1;
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                }
+                checksum += local;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double total = static_cast<double>(accessesPerThread) * threadCount;
+        std::cout << threadCount << " threads: " << total / elapsed.count() << " accesses/sec"
+                  << " (checksum " << checksum.load() << ")" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
 
-int main() {
     // Access the Singleton instance
     Singleton& singleton = Singleton::getInstance();
 
@@ -61,6 +368,17 @@ int main() {
     // Call demonstrating Singleton Behaviour
     Singleton& singleton2 = Singleton::getInstance();
     singleton2.showMessage();
-    
+
+    // Registry of services: Config and Metrics have no dependencies, so they are built in parallel
+    SingletonRegistry registry;
+    registerSampleService(registry, "Config", {}, 40);
+    registerSampleService(registry, "Metrics", {}, 30);
+    registerSampleService(registry, "Logger", {"Config"}, 20);
+    registerSampleService(registry, "Database", {"Config", "Logger"}, 50);
+    registerSampleService(registry, "Cache", {"Config", "Metrics"}, 30);
+    registry.startAll(4, true);
+    registry.get<Service>("Database").showMessage();
+    registry.printReport();
+
     return 0;
 }
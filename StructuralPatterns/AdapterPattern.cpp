@@ -12,16 +12,52 @@
 // To bridge this incompatibility, the Adapter class is introduced.
 // The Adapter class implements the Target interface and internally holds an instance of the Adaptee.
 // It translates the requests from the Target interface into calls to the Adaptee's interface.
+// Besides Request(), which returns a fresh string, the Target can write its result into a caller-supplied string
+// (RequestInto, reusing the string's capacity) or straight into an output sink (WriteRequest). The Adaptee exposes
+// a borrowed std::string_view result, so the adapted call path performs no allocation once the caller's buffer is warm.
+// AsyncAdapter runs blocking adapted calls on a bounded worker pool and returns futures, exposing queue-depth metrics.
+// For bulk data, RecordAdapter converts a whole array of the legacy packed records into a structure-of-arrays layout in
+// one call, byte swapping, widening and scaling four records at a time with SSE2 and falling back to scalar code elsewhere.
+// Run the program with "--bench" to compare allocations per call and calls per second of both APIs, and to measure
+// records per second of the bulk conversion at 1M and 100M records, and slow-request throughput at several concurrency limits.
 
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // The Target interface that the client expects to work with
 class Target {
 public:
     virtual std::string Request() const = 0;
+
+    // Writes the result into out, replacing its contents but keeping its capacity
+    virtual void RequestInto(std::string& out) const {
+        out = Request();
+    }
+
+    // Streams the result into sink without building an intermediate string
+    virtual void WriteRequest(std::ostream& sink) const {
+        sink << Request();
+    }
+
     virtual ~Target() = default;
 };
 
@@ -29,6 +65,11 @@ public:
 class Adaptee {
 public:
     std::string SpecificRequest() const {
+        return std::string(SpecificRequestView());
+    }
+
+    // Borrowed result, valid for as long as the Adaptee
+    std::string_view SpecificRequestView() const {
         return "Adaptee's specific request";
     }
 };
@@ -42,8 +83,24 @@ public:
     Adapter(std::unique_ptr<Adaptee> a) : adaptee(std::move(a)) {}
 
     std::string Request() const override {
-        return "Adapter: (TRANSLATED) " + adaptee->SpecificRequest();
+        std::string result;
+        RequestInto(result);
+        return result;
     }
+
+    void RequestInto(std::string& out) const override {
+        std::string_view specific = adaptee->SpecificRequestView();
+        out.clear();
+        out.reserve(kPrefix.size() + specific.size());
+        out.append(kPrefix).append(specific);
+    }
+
+    void WriteRequest(std::ostream& sink) const override {
+        sink << kPrefix << adaptee->SpecificRequestView();
+    }
+
+private:
+    static constexpr std::string_view kPrefix = "Adapter: (TRANSLATED) ";
 };
 
 // Client code
@@ -51,12 +108,396 @@ void ClientCode(const std::shared_ptr<Target>& target) {
     std::cout << target->Request() << std::endl;
 }
 
-int main() {
+// Client code that owns the buffer and reuses it across calls
+void ClientCodeWithBuffer(const std::shared_ptr<Target>& target, std::string& buffer) {
+    target->RequestInto(buffer);
+    std::cout << buffer << std::endl;
+}
+
+// Asynchronous Adapter
+// Real adaptees are often slow, blocking legacy calls. AsyncAdapter runs the adapted Request() of any Target on a
+// bounded pool of worker threads and hands the client a std::future, so hundreds of requests can be in flight at once.
+// maxConcurrency caps how many adaptee calls run at the same time, maxQueueDepth caps how many wait behind them;
+// RequestAsync() blocks once the queue is full, which pushes back on clients that outpace the adaptee.
+class AsyncAdapter {
+public:
+    struct Metrics {
+        std::size_t queueDepth = 0;
+        std::size_t maxQueueDepth = 0;
+        std::size_t running = 0;
+        long completed = 0;
+    };
+
+    AsyncAdapter(std::shared_ptr<const Target> target, std::size_t maxConcurrency, std::size_t maxQueueDepth)
+        : target(std::move(target)), queueLimit(std::max<std::size_t>(maxQueueDepth, 1)) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(maxConcurrency, 1); ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    AsyncAdapter(const AsyncAdapter&) = delete;
+    AsyncAdapter& operator=(const AsyncAdapter&) = delete;
+
+    // Finishes every queued request before the workers stop
+    ~AsyncAdapter() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::future<std::string> RequestAsync() {
+        std::promise<std::string> reply;
+        std::future<std::string> result = reply.get_future();
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            spaceAvailable.wait(lock, [this]() { return queue.size() < queueLimit; });
+            queue.push_back(std::move(reply));
+            current.queueDepth = queue.size();
+            current.maxQueueDepth = std::max(current.maxQueueDepth, current.queueDepth);
+        }
+        workAvailable.notify_one();
+        return result;
+    }
+
+    Metrics metrics() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return current;
+    }
+
+private:
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return; // stopping and drained
+            }
+            std::promise<std::string> reply = std::move(queue.front());
+            queue.pop_front();
+            current.queueDepth = queue.size();
+            ++current.running;
+            spaceAvailable.notify_one();
+
+            lock.unlock();
+            std::string result;
+            std::exception_ptr error;
+            try {
+                result = target->Request(); // the blocking adaptee call
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            --current.running;
+            ++current.completed;
+            // Fulfil the future only after the metrics are updated, so a client that saw its reply also sees it counted
+            if (error) {
+                reply.set_exception(error);
+            } else {
+                reply.set_value(std::move(result));
+            }
+        }
+    }
+
+    std::shared_ptr<const Target> target;
+    std::size_t queueLimit;
+    mutable std::mutex mtx;
+    std::condition_variable workAvailable;
+    std::condition_variable spaceAvailable;
+    std::deque<std::promise<std::string>> queue;
+    Metrics current;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
+
+// Stand-in for a slow legacy system behind the Target interface
+class SlowLegacyAdapter : public Target {
+public:
+    explicit SlowLegacyAdapter(std::chrono::milliseconds latency) : latency(latency) {}
+
+    std::string Request() const override {
+        std::this_thread::sleep_for(latency); // blocking legacy call
+        return "SlowLegacyAdapter: (TRANSLATED) legacy reply";
+    }
+
+private:
+    std::chrono::milliseconds latency;
+};
+
+// Bulk Record Adapter
+// The legacy adaptee hands back arrays of packed 8-byte records: a big-endian 32-bit id, a big-endian signed 16-bit
+// reading and a little-endian 16-bit level in hundredths. Our code wants a structure of arrays with native ids,
+// readings widened to 32 bits and levels scaled to float, so the RecordAdapter converts a whole span in one call.
+struct LegacyRecord {
+    unsigned char id[4];      // big-endian
+    unsigned char reading[2]; // big-endian, signed
+    unsigned char level[2];   // little-endian, hundredths
+};
+
+static_assert(sizeof(LegacyRecord) == 8, "LegacyRecord must stay packed into 8 bytes");
+
+// The legacy adaptee: owns the packed records and exposes them as an array
+class LegacyRecordStore {
+public:
+    explicit LegacyRecordStore(std::vector<LegacyRecord> records) : records_(std::move(records)) {}
+
+    const LegacyRecord* records() const {
+        return records_.data();
+    }
+
+    std::size_t size() const {
+        return records_.size();
+    }
+
+private:
+    std::vector<LegacyRecord> records_;
+};
+
+// Target layout: one contiguous column per field
+struct RecordColumns {
+    std::vector<std::uint32_t> ids;
+    std::vector<std::int32_t> readings;
+    std::vector<float> levels;
+
+    void resize(std::size_t count) {
+        ids.resize(count);
+        readings.resize(count);
+        levels.resize(count);
+    }
+};
+
+class RecordAdapter {
+public:
+    static constexpr float kLevelScale = 0.01f;
+
+    explicit RecordAdapter(const LegacyRecordStore& store) : store(store) {}
+
+    // Converts every record of the adaptee, using the SIMD kernel where available
+    void convertAll(RecordColumns& out) const {
+        out.resize(store.size());
+        convert(store.records(), store.size(), out, 0);
+    }
+
+    // Converts count records into out starting at row offset; out must already be large enough
+    static void convert(const LegacyRecord* records, std::size_t count, RecordColumns& out, std::size_t offset) {
+        std::size_t done = 0;
+#if defined(__SSE2__)
+        done = convertSse2(records, count, out, offset);
+#endif
+        convertScalar(records + done, count - done, out, offset + done);
+    }
+
+    // Portable fallback, also used for the tail the vector kernel leaves over
+    static void convertScalar(const LegacyRecord* records, std::size_t count, RecordColumns& out, std::size_t offset) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const LegacyRecord& record = records[i];
+            out.ids[offset + i] = (std::uint32_t(record.id[0]) << 24) | (std::uint32_t(record.id[1]) << 16) |
+                                  (std::uint32_t(record.id[2]) << 8) | std::uint32_t(record.id[3]);
+            out.readings[offset + i] = static_cast<std::int16_t>((record.reading[0] << 8) | record.reading[1]);
+            out.levels[offset + i] = static_cast<float>(record.level[0] | (record.level[1] << 8)) * kLevelScale;
+        }
+    }
+
+private:
+#if defined(__SSE2__)
+    // Four records per step with plain SSE2 (baseline on x86-64, which is little-endian):
+    // two loads split into an id lane and a reading/level lane, then byte swap, sign-extend and scale in registers.
+    static std::size_t convertSse2(const LegacyRecord* records, std::size_t count, RecordColumns& out, std::size_t offset) {
+        const __m128i lowByteMask = _mm_set1_epi32(0x00FF00FF);
+        const __m128 scale = _mm_set1_ps(kLevelScale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 first = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(records + i)));
+            __m128 second = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(records + i + 2)));
+            __m128i ids = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i rest = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            // 32-bit byte swap: swap bytes inside each 16-bit half, then swap the halves
+            ids = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(ids, 8), lowByteMask),
+                               _mm_slli_epi32(_mm_and_si128(ids, lowByteMask), 8));
+            ids = _mm_or_si128(_mm_srli_epi32(ids, 16), _mm_slli_epi32(ids, 16));
+
+            // Reading: move into the upper half, swap its two bytes, arithmetic shift widens with sign
+            __m128i reading = _mm_slli_epi32(rest, 16);
+            reading = _mm_or_si128(_mm_and_si128(_mm_slli_epi32(reading, 8), _mm_set1_epi32(int(0xFF000000))),
+                                   _mm_and_si128(_mm_srli_epi32(reading, 8), _mm_set1_epi32(0x00FF0000)));
+            reading = _mm_srai_epi32(reading, 16);
+
+            // Level: already little-endian in the upper half, zero-extend, convert and scale
+            __m128 level = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(rest, 16)), scale);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.ids.data() + offset + i), ids);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.readings.data() + offset + i), reading);
+            _mm_storeu_ps(out.levels.data() + offset + i, level);
+        }
+        return i;
+    }
+#endif
+
+    const LegacyRecordStore& store;
+};
+
+// Counts every global operator new so the benchmark can report heap allocations.
+// The replacements are kept out of line so GCC does not mistake the inlined malloc/free for mismatched allocations.
+std::atomic<long> heapAllocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+// The original translation: the Adaptee result returned by value, then concatenated into a new string
+std::string legacyRequest(const Adaptee& adaptee) {
+    return "Adapter: (TRANSLATED) " + adaptee.SpecificRequest();
+}
+
+void runRequestBenchmark(const Target& target, const Adaptee& adaptee) {
+    const long calls = 5000000;
+    std::size_t checksum = 0;
+
+    long before = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < calls; ++i) {
+        checksum += legacyRequest(adaptee).size();
+    }
+    std::chrono::duration<double> legacy = std::chrono::steady_clock::now() - start;
+    long legacyAllocations = heapAllocations - before;
+
+    std::string buffer;
+    before = heapAllocations;
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < calls; ++i) {
+        target.RequestInto(buffer);
+        checksum += buffer.size();
+    }
+    std::chrono::duration<double> intoBuffer = std::chrono::steady_clock::now() - start;
+    long bufferAllocations = heapAllocations - before;
+
+    std::cout << "Request() by value: " << calls / legacy.count() << " calls/sec, "
+              << static_cast<double>(legacyAllocations) / calls << " allocations/call" << std::endl;
+    std::cout << "RequestInto(buffer): " << calls / intoBuffer.count() << " calls/sec, "
+              << static_cast<double>(bufferAllocations) / calls << " allocations/call (checksum " << checksum << ")" << std::endl;
+}
+
+std::vector<LegacyRecord> makeLegacyRecords(std::size_t count) {
+    std::vector<LegacyRecord> records(count);
+    std::uint32_t state = 12345;
+    for (std::size_t i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u; // cheap LCG, we only need varied bytes
+        std::memcpy(&records[i], &state, 4);
+        std::uint32_t more = state ^ (state >> 13);
+        std::memcpy(reinterpret_cast<unsigned char*>(&records[i]) + 4, &more, 4);
+    }
+    return records;
+}
+
+// Every element of every column, so a single mistranslated record is caught
+bool sameColumns(const RecordColumns& a, const RecordColumns& b) {
+    return a.ids == b.ids && a.readings == b.readings && a.levels == b.levels;
+}
+
+void runRecordBenchmark() {
+    for (std::size_t count : {std::size_t(1000000), std::size_t(100000000)}) {
+        LegacyRecordStore store(makeLegacyRecords(count));
+        // Each path writes into its own columns, touched once up front so page faults are not timed
+        RecordColumns scalarColumns;
+        RecordColumns bulkColumns;
+        scalarColumns.resize(count);
+        bulkColumns.resize(count);
+
+        auto start = std::chrono::steady_clock::now();
+        RecordAdapter::convertScalar(store.records(), store.size(), scalarColumns, 0);
+        std::chrono::duration<double> scalar = std::chrono::steady_clock::now() - start;
+
+        RecordAdapter adapter(store);
+        start = std::chrono::steady_clock::now();
+        adapter.convertAll(bulkColumns);
+        std::chrono::duration<double> bulk = std::chrono::steady_clock::now() - start;
+
+        std::cout << count << " records: scalar " << count / scalar.count() << " records/sec, bulk "
+                  << count / bulk.count() << " records/sec, results "
+                  << (sameColumns(scalarColumns, bulkColumns) ? "match" : "DIFFER") << std::endl;
+    }
+}
+
+// Many slow requests in flight at different concurrency limits
+void runAsyncBenchmark() {
+    const int requests = 200;
+    std::shared_ptr<const Target> slow = std::make_shared<SlowLegacyAdapter>(std::chrono::milliseconds(10));
+    for (std::size_t concurrency : {std::size_t(1), std::size_t(16), std::size_t(64)}) {
+        AsyncAdapter async(slow, concurrency, 256);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<std::string>> replies;
+        for (int i = 0; i < requests; ++i) {
+            replies.push_back(async.RequestAsync());
+        }
+        std::size_t bytes = 0;
+        for (auto& reply : replies) {
+            bytes += reply.get().size();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        AsyncAdapter::Metrics metrics = async.metrics();
+        std::cout << "concurrency " << concurrency << ": " << requests / elapsed.count() << " requests/sec, max queue depth "
+                  << metrics.maxQueueDepth << " (" << bytes << " bytes received)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     std::unique_ptr<Adaptee> adaptee = std::make_unique<Adaptee>();
+    if (argc > 1 && std::string_view(argv[1]) == "--bench") {
+        Adaptee benchAdaptee;
+        runRequestBenchmark(Adapter(std::make_unique<Adaptee>()), benchAdaptee);
+        runRecordBenchmark();
+        runAsyncBenchmark();
+        return 0;
+    }
     std::shared_ptr<Target> adapter = std::make_shared<Adapter>(std::move(adaptee));
-    
+
     std::cout << "Client: I can work just fine with the Target objects:\n";
     ClientCode(adapter);
 
+    std::string buffer;
+    ClientCodeWithBuffer(adapter, buffer);
+    adapter->WriteRequest(std::cout);
+    std::cout << std::endl;
+
+    // Keep several slow adapted requests in flight instead of waiting for each one
+    {
+        AsyncAdapter async(std::make_shared<SlowLegacyAdapter>(std::chrono::milliseconds(20)), 4, 16);
+        std::vector<std::future<std::string>> replies;
+        for (int i = 0; i < 8; ++i) {
+            replies.push_back(async.RequestAsync());
+        }
+        for (auto& reply : replies) {
+            std::cout << reply.get() << std::endl;
+        }
+        std::cout << "Async requests completed: " << async.metrics().completed << std::endl;
+    }
+
+    // Bulk conversion of legacy records into columns
+    LegacyRecordStore store({{{0x00, 0x00, 0x01, 0x02}, {0xFF, 0x9C}, {0xE8, 0x03}},
+                             {{0x00, 0x01, 0x00, 0x00}, {0x00, 0x64}, {0x10, 0x27}}});
+    RecordColumns columns;
+    RecordAdapter(store).convertAll(columns);
+    for (std::size_t i = 0; i < columns.ids.size(); ++i) {
+        std::cout << "Record id " << columns.ids[i] << ", reading " << columns.readings[i] << ", level " << columns.levels[i] << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -10,10 +10,36 @@
 // In this example, Bridge Pattern is used to separate the abstraction (RemoteControl) from its implementations (BasicRemote and AdvancedRemote). 
 // The Device interface acts as the Implementor, with concrete implementations like TV and Radio.
 // This allows the RemoteControl abstraction to operate independently of the device it controls, promoting flexibility and scalability. 
+// A remote can optionally record its operations into a CommandBuffer, which coalesces redundant pending ones (back-to-back
+// volume changes keep the last, back-to-back power changes keep the final state) and hands the remainder to
+// Device::applyBatch() in one call, in the order they were recorded.
+// When the device type is known at build time, StaticRemoteControl<DeviceT> keeps the same split as a template and inlines
+// through both layers; VariantRemoteControl covers a closed set of device types with std::visit.
+// Run the program with "--bench" to compare calls per second of the runtime, variant and template bridges.
 
 
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <chrono>
+#include <variant>
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <thread>
+
+// One recorded device operation
+struct DeviceCommand {
+    enum class Kind {
+        TurnOn,
+        TurnOff,
+        SetVolume
+    };
+
+    Kind kind;
+    int volume = 0;
+};
 
 // Implementor Interface
 class Device {
@@ -22,10 +48,27 @@ public:
     virtual void turnOn() = 0;
     virtual void turnOff() = 0;
     virtual void setVolume(int volume) = 0;
+
+    // Applies a whole batch at once. Devices with a cheaper bulk path can override this.
+    virtual void applyBatch(const std::vector<DeviceCommand>& commands) {
+        for (const DeviceCommand& command : commands) {
+            switch (command.kind) {
+                case DeviceCommand::Kind::TurnOn:
+                    turnOn();
+                    break;
+                case DeviceCommand::Kind::TurnOff:
+                    turnOff();
+                    break;
+                case DeviceCommand::Kind::SetVolume:
+                    setVolume(command.volume);
+                    break;
+            }
+        }
+    }
 };
 
 // ConcreteImplementor 1
-class TV : public Device {
+class TV final : public Device {
 public:
     void turnOn() override {
         std::cout << "Turning on the TV.\n";
@@ -39,7 +82,7 @@ public:
 };
 
 // ConcreteImplementor 2
-class Radio : public Device {
+class Radio final : public Device {
 public:
     void turnOn() override {
         std::cout << "Turning on the Radio.\n";
@@ -52,18 +95,165 @@ public:
     }
 };
 
+// Command Buffer
+// Sits between the abstraction and the implementor. Operations are recorded instead of being sent one by one,
+// redundant ones are coalesced, and the rest reach the device as a single batch on flush(), in recorded order.
+// Coalescing only looks at what is pending, never at what the device was sent before, since other remotes may share
+// the device: a volume change replaces a volume change recorded right before it, a power change replaces a power change
+// recorded right before it, and a power change is dropped when the last pending power change already does the same.
+// A flush happens on demand, when recording an operation once maxPending operations or maxDelay have piled up, or when
+// the owner calls flushIfDue() at or after deadline(). Recording alone cannot bound latency: the tail of a burst waits
+// until someone polls, so an owner that wants the time limit honoured sleeps until deadline() or polls from a timer.
+class CommandBuffer {
+public:
+    struct Counters {
+        long recorded = 0;
+        long sent = 0;
+        long flushes = 0;
+
+        long saved() const {
+            return recorded - sent;
+        }
+    };
+
+    CommandBuffer(std::size_t maxPending, std::chrono::milliseconds maxDelay) : maxPending(maxPending), maxDelay(maxDelay) {}
+
+    void record(Device& device, DeviceCommand command) {
+        if (pendingCount == 0) {
+            firstPending = std::chrono::steady_clock::now();
+        }
+        ++pendingCount;
+        ++counters.recorded;
+        if (command.kind == DeviceCommand::Kind::SetVolume) {
+            if (!pending.empty() && pending.back().kind == DeviceCommand::Kind::SetVolume) {
+                pending.back() = command;
+            } else {
+                pending.push_back(command);
+            }
+        } else {
+            if (!pending.empty() && pending.back().kind != DeviceCommand::Kind::SetVolume) {
+                pending.pop_back(); // superseded by this power change
+            }
+            const DeviceCommand* lastPower = nullptr;
+            for (auto it = pending.rbegin(); it != pending.rend() && !lastPower; ++it) {
+                if (it->kind != DeviceCommand::Kind::SetVolume) {
+                    lastPower = &*it;
+                }
+            }
+            if (!lastPower || lastPower->kind != command.kind) {
+                pending.push_back(command);
+            }
+        }
+        if (pendingCount >= maxPending || std::chrono::steady_clock::now() - firstPending >= maxDelay) {
+            flush(device);
+        }
+    }
+
+    // When the pending window has waited maxDelay; time_point::max() while nothing is pending
+    std::chrono::steady_clock::time_point deadline() const {
+        return pendingCount == 0 ? std::chrono::steady_clock::time_point::max() : firstPending + maxDelay;
+    }
+
+    // Flushes if the pending window has reached its deadline; returns whether it did
+    bool flushIfDue(Device& device) {
+        if (std::chrono::steady_clock::now() < deadline()) {
+            return false;
+        }
+        flush(device);
+        return true;
+    }
+
+    void flush(Device& device) {
+        if (pendingCount == 0) {
+            return;
+        }
+        if (!pending.empty()) {
+            device.applyBatch(pending);
+        }
+        counters.sent += static_cast<long>(pending.size());
+        ++counters.flushes;
+        pendingCount = 0;
+        pending.clear(); // keeps its capacity for the next window
+    }
+
+    const Counters& stats() const {
+        return counters;
+    }
+
+private:
+    std::size_t maxPending;
+    std::chrono::milliseconds maxDelay;
+    std::chrono::steady_clock::time_point firstPending;
+    std::size_t pendingCount = 0;
+
+    std::vector<DeviceCommand> pending; // coalesced operations of the current window, in recorded order
+    Counters counters;
+};
+
 // Abstraction
 class RemoteControl {
 protected:
     std::shared_ptr<Device> device;
+    std::unique_ptr<CommandBuffer> buffer; // null means every operation goes straight to the device
+
+    // Route each operation either to the command buffer or directly to the device
+    void sendTurnOn() {
+        if (buffer) {
+            buffer->record(*device, {DeviceCommand::Kind::TurnOn});
+        } else {
+            device->turnOn();
+        }
+    }
+    void sendTurnOff() {
+        if (buffer) {
+            buffer->record(*device, {DeviceCommand::Kind::TurnOff});
+        } else {
+            device->turnOff();
+        }
+    }
+    void sendVolume(int volume) {
+        if (buffer) {
+            buffer->record(*device, {DeviceCommand::Kind::SetVolume, volume});
+        } else {
+            device->setVolume(volume);
+        }
+    }
+
 public:
     RemoteControl(std::shared_ptr<Device> device) : device(device) {}
-    virtual ~RemoteControl() {}
+    virtual ~RemoteControl() {
+        flush();
+    }
     virtual void turnOn() {
-        device->turnOn();
+        sendTurnOn();
     }
     virtual void turnOff() {
-        device->turnOff();
+        sendTurnOff();
+    }
+
+    // Start recording operations into a coalescing command buffer
+    void enableBuffering(std::size_t maxPending, std::chrono::milliseconds maxDelay) {
+        flush();
+        buffer = std::make_unique<CommandBuffer>(maxPending, maxDelay);
+    }
+
+    void flush() {
+        if (buffer) {
+            buffer->flush(*device);
+        }
+    }
+
+    // For owners that poll: sends buffered operations whose maxDelay has run out
+    bool flushIfDue() {
+        return buffer && buffer->flushIfDue(*device);
+    }
+
+    std::chrono::steady_clock::time_point flushDeadline() const {
+        return buffer ? buffer->deadline() : std::chrono::steady_clock::time_point::max();
+    }
+
+    const CommandBuffer* commandBuffer() const {
+        return buffer.get();
     }
 };
 
@@ -72,12 +262,16 @@ class BasicRemote : public RemoteControl {
 public:
     BasicRemote(std::shared_ptr<Device> device) : RemoteControl(device) {}
     void turnOn() override {
-        std::cout << "Basic Remote: ";
-        device->turnOn();
+        if (!buffer) {
+            std::cout << "Basic Remote: ";
+        }
+        sendTurnOn();
     }
     void turnOff() override {
-        std::cout << "Basic Remote: ";
-        device->turnOff();
+        if (!buffer) {
+            std::cout << "Basic Remote: ";
+        }
+        sendTurnOff();
     }
 };
 
@@ -86,20 +280,145 @@ class AdvancedRemote : public RemoteControl {
 public:
     AdvancedRemote(std::shared_ptr<Device> device) : RemoteControl(device) {}
     void turnOn() override {
-        std::cout << "Advanced Remote: ";
-        device->turnOn();
+        if (!buffer) {
+            std::cout << "Advanced Remote: ";
+        }
+        sendTurnOn();
+    }
+    void turnOff() override {
+        if (!buffer) {
+            std::cout << "Advanced Remote: ";
+        }
+        sendTurnOff();
+    }
+    void setVolume(int volume) {
+        if (!buffer) {
+            std::cout << "Advanced Remote: ";
+        }
+        sendVolume(volume);
+    }
+};
+
+// ConcreteImplementor without console output, used to measure dispatch cost
+class CountingDevice final : public Device {
+public:
+    void turnOn() override {
+        on = true;
+        ++operations;
     }
     void turnOff() override {
-        std::cout << "Advanced Remote: ";
-        device->turnOff();
+        on = false;
+        ++operations;
+    }
+    void setVolume(int newVolume) override {
+        volume = newVolume;
+        ++operations;
+    }
+
+    long operationCount() const {
+        return operations;
+    }
+
+private:
+    bool on = false;
+    int volume = 0;
+    long operations = 0;
+};
+
+// Compile-time Bridge
+// When the device type is fixed at build time the same abstraction/implementor split can be expressed as a template.
+// The remote owns its device by value (no shared_ptr, no reference counting) and calls it without virtual dispatch,
+// so both layers inline. The runtime RemoteControl above stays the choice for mixing device types.
+template <typename DeviceT>
+class StaticRemoteControl {
+public:
+    // Only takes part in overload resolution for arguments DeviceT can be built from, so copying a remote still
+    // picks the copy constructor instead of forwarding the remote itself to the device
+    template <typename... Args, typename = std::enable_if_t<std::is_constructible_v<DeviceT, Args&&...>>>
+    explicit StaticRemoteControl(Args&&... args) : device(std::forward<Args>(args)...) {}
+
+    void turnOn() {
+        device.turnOn();
+    }
+    void turnOff() {
+        device.turnOff();
+    }
+    void setVolume(int volume) {
+        device.setVolume(volume);
+    }
+
+    DeviceT& getDevice() {
+        return device;
+    }
+
+private:
+    DeviceT device;
+};
+
+// Middle ground: a closed set of device types held in a std::variant, dispatched through std::visit
+class VariantRemoteControl {
+public:
+    using AnyDevice = std::variant<TV, Radio, CountingDevice>;
+
+    explicit VariantRemoteControl(AnyDevice device) : device(std::move(device)) {}
+
+    void turnOn() {
+        std::visit([](auto& concrete) { concrete.turnOn(); }, device);
+    }
+    void turnOff() {
+        std::visit([](auto& concrete) { concrete.turnOff(); }, device);
     }
     void setVolume(int volume) {
-        std::cout << "Advanced Remote: ";
-        device->setVolume(volume);
+        std::visit([volume](auto& concrete) { concrete.setVolume(volume); }, device);
     }
+
+    AnyDevice& getDevice() {
+        return device;
+    }
+
+private:
+    AnyDevice device;
 };
 
-int main() {
+// Benchmark: calls per second through the runtime bridge, the variant bridge and the template bridge
+template <typename Remote>
+double measureCalls(Remote& remote, long iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        remote.turnOn();
+        remote.turnOff();
+        std::atomic_signal_fence(std::memory_order_seq_cst); // keeps the compiler from collapsing the loop
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return 2.0 * iterations / elapsed.count();
+}
+
+void runBenchmark() {
+    const long iterations = 100000000;
+
+    // Held through the base class pointers the runtime bridge is normally used with
+    std::shared_ptr<Device> counting = std::make_shared<CountingDevice>();
+    std::unique_ptr<RemoteControl> runtimeRemote = std::make_unique<RemoteControl>(counting);
+    double runtimeRate = measureCalls(*runtimeRemote, iterations);
+
+    VariantRemoteControl variantRemote(CountingDevice{});
+    double variantRate = measureCalls(variantRemote, iterations);
+
+    StaticRemoteControl<CountingDevice> staticRemote;
+    double staticRate = measureCalls(staticRemote, iterations);
+
+    std::cout << "runtime bridge: " << runtimeRate << " calls/sec" << std::endl;
+    std::cout << "variant bridge: " << variantRate << " calls/sec" << std::endl;
+    std::cout << "template bridge: " << staticRate << " calls/sec (" << staticRemote.getDevice().operationCount()
+              << " operations)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     std::shared_ptr<Device> tv = std::make_shared<TV>();
     std::shared_ptr<Device> radio = std::make_shared<Radio>();
 
@@ -113,5 +432,28 @@ int main() {
     advancedRemote->turnOff();
     advancedRemote->setVolume(10);
 
+    // A burst of control traffic, buffered and coalesced into one batch
+    std::shared_ptr<AdvancedRemote> bufferedRemote = std::make_shared<AdvancedRemote>(tv);
+    bufferedRemote->enableBuffering(64, std::chrono::milliseconds(50));
+    bufferedRemote->turnOn();
+    for (int volume = 1; volume <= 20; ++volume) {
+        bufferedRemote->setVolume(volume);
+    }
+    bufferedRemote->turnOff();
+    bufferedRemote->turnOn();
+    // Nothing else is recorded after the burst, so wait for its deadline and let the buffer send it
+    std::this_thread::sleep_until(bufferedRemote->flushDeadline());
+    bufferedRemote->flushIfDue();
+    const CommandBuffer::Counters& counters = bufferedRemote->commandBuffer()->stats();
+    std::cout << "Buffered remote: " << counters.recorded << " operations recorded, " << counters.sent
+              << " sent to the device, " << counters.saved() << " saved by coalescing" << std::endl;
+
+    // Device type fixed at compile time, and a closed set of device types
+    StaticRemoteControl<Radio> staticRemote;
+    staticRemote.turnOn();
+    staticRemote.setVolume(5);
+    VariantRemoteControl variantRemote(TV{});
+    variantRemote.turnOff();
+
     return 0;
 }
\ No newline at end of file
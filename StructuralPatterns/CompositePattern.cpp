@@ -16,56 +16,1074 @@
 // objects, including both simple shapes and other CompositeGraphic objects, allowing for nested compositions.
 // By calling the draw method on a CompositeGraphic object, all its child graphics are drawn, demonstrating how the Composite
 // Pattern enables treating individual objects and compositions of objects uniformly.
+// Graphics draw onto a Canvas, which prints each shape for the demo or just counts them when measuring.
+// For very large scenes a tree can be frozen into a FrozenComposite: a contiguous pre-order array of node records
+// (type tag, subtree size, payload index) with leaf payloads stored per type, so drawing becomes a linear scan
+// instead of recursive virtual calls through shared_ptrs. drawByType() draws all leaves of one type together.
+// For scenes that change a little between frames an IncrementalRenderer redraws only what changed: mutating a leaf or
+// calling add() marks the path up to the root dirty, and clean subtrees are copied from the previous frame's commands
+// as one block instead of being walked again. Each pass reports how many nodes were visited and how many were skipped.
+// ParallelDrawer spreads large subtrees over a work-stealing thread pool and draws anything below a grain size with
+// plain recursion; its ordered mode keeps the same draw order as a sequential draw.
+// Leaves carry their geometry and every composite keeps a bounding box around its children, grown as shapes are
+// added or changed, so draw(viewport) can skip whole subtrees that lie outside the viewport.
+// Run the program with "--bench" to compare draw throughput of the pointer tree and the frozen layout, the cost of
+// incremental frames against full redraws, parallel scaling on balanced and skewed trees, and culled draws against
+// viewport size.
 
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// One recorded draw call, kept so unchanged parts of a scene can be replayed instead of redrawn
+enum class DrawCommand : std::uint8_t {
+    Circle,
+    Rectangle
+};
+
+// Where graphics are drawn to. With no stream the canvas only counts what was drawn; given a command list it
+// records the draw calls so they can be replayed later.
+class Canvas {
+public:
+    explicit Canvas(std::ostream* out = nullptr) : out(out) {}
+    explicit Canvas(std::vector<DrawCommand>* commands) : out(nullptr), commands(commands) {}
+
+    void drawCircle() {
+        ++shapes;
+        if (out) {
+            *out << "Drawing Circle" << std::endl;
+        }
+        if (commands) {
+            commands->push_back(DrawCommand::Circle);
+        }
+        std::atomic_signal_fence(std::memory_order_seq_cst); // one real step per shape, even when only counting
+    }
+
+    void drawRectangle() {
+        ++shapes;
+        if (out) {
+            *out << "Drawing Rectangle" << std::endl;
+        }
+        if (commands) {
+            commands->push_back(DrawCommand::Rectangle);
+        }
+        std::atomic_signal_fence(std::memory_order_seq_cst); // one real step per shape, even when only counting
+    }
+
+    void replay(DrawCommand command) {
+        if (command == DrawCommand::Circle) {
+            drawCircle();
+        } else {
+            drawRectangle();
+        }
+    }
+
+    long shapesDrawn() const {
+        return shapes;
+    }
+
+private:
+    std::ostream* out;
+    std::vector<DrawCommand>* commands = nullptr;
+    long shapes = 0;
+};
+
+// Axis-aligned bounding box. An empty box has min > max and intersects nothing.
+struct Bounds {
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    double maxX = -std::numeric_limits<double>::infinity();
+    double maxY = -std::numeric_limits<double>::infinity();
+
+    static Bounds of(double minX, double minY, double maxX, double maxY) {
+        Bounds bounds;
+        bounds.minX = minX;
+        bounds.minY = minY;
+        bounds.maxX = maxX;
+        bounds.maxY = maxY;
+        return bounds;
+    }
+
+    bool intersects(const Bounds& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    bool contains(const Bounds& other) const {
+        return minX <= other.minX && other.maxX <= maxX && minY <= other.minY && other.maxY <= maxY;
+    }
+
+    void expand(const Bounds& other) {
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+
+    double area() const {
+        return maxX < minX || maxY < minY ? 0.0 : (maxX - minX) * (maxY - minY);
+    }
+};
+
+// What a viewport draw did: nodes looked at, graphics rejected by their box test (a culled composite skips its
+// whole subtree), and shapes actually drawn
+struct CullStats {
+    long visited = 0;
+    long culled = 0;
+    long drawn = 0;
+};
+
+class FrozenComposite;
+class IncrementalRenderer;
 
 // Component Interface:
 class Graphic {
 public:
-    virtual void draw() const = 0;
+    void draw() const {
+        Canvas canvas(&std::cout);
+        drawTo(canvas);
+    }
+
+    // Draws only the graphics whose bounds overlap the viewport
+    CullStats draw(const Bounds& viewport) const {
+        Canvas canvas(&std::cout);
+        CullStats stats;
+        drawTo(canvas, viewport, stats);
+        return stats;
+    }
+
+    virtual void drawTo(Canvas& canvas) const = 0;
+    virtual void drawTo(Canvas& canvas, const Bounds& viewport, CullStats& stats) const = 0;
+    // Appends this graphic (and its children) to a frozen, flattened copy of the tree
+    virtual void freezeInto(FrozenComposite& frozen) const = 0;
     virtual ~Graphic() = default;
+
+    // Marks this graphic and every composite above it as needing a redraw. A dirty graphic always has dirty
+    // ancestors, so the walk stops at the first one that is already marked.
+    void markDirty() {
+        dirty = true;
+        for (std::shared_ptr<Graphic> node = parent.lock(); node && !node->dirty; node = node->parent.lock()) {
+            node->dirty = true;
+        }
+    }
+
+    bool isDirty() const {
+        return dirty;
+    }
+
+    // Number of nodes in this graphic's subtree, itself included
+    std::size_t subtreeSize() const {
+        return nodeCount;
+    }
+
+    // For a leaf its own extent; for a composite a box around all of its children. Composite boxes only ever grow,
+    // so after a leaf shrinks or moves they may be larger than needed, which costs visits but never hides anything.
+    const Bounds& getBounds() const {
+        return bounds;
+    }
+
+    // Direct children, empty for leaves
+    virtual const std::vector<std::shared_ptr<Graphic>>& getChildren() const {
+        static const std::vector<std::shared_ptr<Graphic>> none;
+        return none;
+    }
+
+protected:
+    friend class CompositeGraphic;
+    friend class IncrementalRenderer;
+
+    // Appends this graphic's draw commands to the renderer's frame and returns how many nodes it covers.
+    // oldBegin/newBegin are where this graphic's commands start in the previous and the current frame.
+    virtual std::size_t record(IncrementalRenderer& renderer, std::size_t oldBegin, std::size_t newBegin) const = 0;
+
+    // Forgets cached output for the whole subtree, used when it moves under a new parent or a new renderer
+    virtual void invalidate() const {
+        dirty = true;
+    }
+
+    // Replaces this graphic's bounds and grows the boxes above it as far as needed. Every composite box contains
+    // its children's, so the walk stops at the first ancestor that already covers the new box.
+    void setBounds(const Bounds& newBounds) {
+        bounds = newBounds;
+        for (std::shared_ptr<Graphic> node = parent.lock(); node && !node->bounds.contains(newBounds);
+             node = node->parent.lock()) {
+            node->bounds.expand(newBounds);
+        }
+    }
+
+    // Records this graphic if it is dirty, otherwise copies its commands from the previous frame
+    std::size_t renderInto(IncrementalRenderer& renderer, std::size_t oldParentBegin, std::size_t newParentBegin) const;
+
+private:
+    std::weak_ptr<Graphic> parent;      // the composite this graphic was last added to
+    mutable bool dirty = true;
+    mutable std::size_t cacheOffset = 0; // start of this graphic's commands, relative to its parent's start
+    mutable std::size_t cacheLength = 0;
+    mutable std::size_t cachedNodes = 1;
+    std::size_t nodeCount = 1;
+    Bounds bounds;
 };
 
+// Incremental Renderer
+// Keeps the previous frame's draw commands. Every graphic remembers where its commands sit relative to its parent,
+// so a clean subtree can be copied across as one block, and moving it in the frame keeps its children's offsets valid.
+// Use one renderer per tree: the cached offsets belong to the renderer that last drew the tree.
+class IncrementalRenderer {
+public:
+    struct PassStats {
+        long visited = 0; // dirty nodes that were recorded again
+        long skipped = 0; // nodes inside clean subtrees that were copied from the previous frame
+    };
+
+    void render(const Graphic& root) {
+        if (&root != lastRoot) {
+            root.invalidate();
+            lastRoot = &root;
+        }
+        current.clear();
+        stats = PassStats();
+        root.renderInto(*this, 0, 0);
+        previous.swap(current);
+    }
+
+    void present(Canvas& canvas) const {
+        for (DrawCommand command : previous) {
+            canvas.replay(command);
+        }
+    }
+
+    const std::vector<DrawCommand>& frame() const {
+        return previous;
+    }
+
+    const PassStats& lastPass() const {
+        return stats;
+    }
+
+    // Used by leaves while recording
+    void emit(DrawCommand command) {
+        current.push_back(command);
+    }
+
+private:
+    friend class Graphic;
+
+    void reuse(std::size_t begin, std::size_t length, std::size_t nodes) {
+        current.insert(current.end(), previous.begin() + begin, previous.begin() + begin + length);
+        stats.skipped += static_cast<long>(nodes);
+    }
+
+    std::vector<DrawCommand> previous;
+    std::vector<DrawCommand> current;
+    PassStats stats;
+    const Graphic* lastRoot = nullptr;
+};
+
+std::size_t Graphic::renderInto(IncrementalRenderer& renderer, std::size_t oldParentBegin,
+                                std::size_t newParentBegin) const {
+    std::size_t oldBegin = oldParentBegin + cacheOffset;
+    std::size_t newBegin = renderer.current.size();
+    if (dirty) {
+        ++renderer.stats.visited;
+        cachedNodes = record(renderer, oldBegin, newBegin);
+        cacheLength = renderer.current.size() - newBegin;
+        dirty = false;
+    } else {
+        renderer.reuse(oldBegin, cacheLength, cachedNodes);
+    }
+    cacheOffset = newBegin - newParentBegin;
+    return cachedNodes;
+}
+
 // Leaf
-class Circle : public Graphic {
+class Circle final : public Graphic {
 public:
-    void draw() const override {
-        std::cout << "Drawing Circle" << std::endl;
+    explicit Circle(double centerX = 0.0, double centerY = 0.0, double radius = 1.0)
+        : centerX(centerX), centerY(centerY), radius(radius) {
+        setBounds(extent());
+    }
+
+    void drawTo(Canvas& canvas) const override {
+        canvas.drawCircle();
+    }
+
+    void drawTo(Canvas& canvas, const Bounds& viewport, CullStats& stats) const override {
+        ++stats.visited;
+        if (!viewport.intersects(getBounds())) {
+            ++stats.culled;
+            return;
+        }
+        ++stats.drawn;
+        canvas.drawCircle();
     }
+
+    void freezeInto(FrozenComposite& frozen) const override;
+
+    void setRadius(double newRadius) {
+        radius = newRadius;
+        setBounds(extent());
+        markDirty();
+    }
+
+    void moveTo(double newCenterX, double newCenterY) {
+        centerX = newCenterX;
+        centerY = newCenterY;
+        setBounds(extent());
+        markDirty();
+    }
+
+    double getRadius() const {
+        return radius;
+    }
+
+protected:
+    std::size_t record(IncrementalRenderer& renderer, std::size_t, std::size_t) const override {
+        renderer.emit(DrawCommand::Circle);
+        return 1;
+    }
+
+private:
+    Bounds extent() const {
+        return Bounds::of(centerX - radius, centerY - radius, centerX + radius, centerY + radius);
+    }
+
+    double centerX;
+    double centerY;
+    double radius;
 };
 
 // Leaf
-class Rectangle : public Graphic {
+class Rectangle final : public Graphic {
 public:
-    void draw() const override {
-        std::cout << "Drawing Rectangle" << std::endl;
+    explicit Rectangle(double x = 0.0, double y = 0.0, double width = 1.0, double height = 1.0)
+        : x(x), y(y), width(width), height(height) {
+        setBounds(extent());
+    }
+
+    void drawTo(Canvas& canvas) const override {
+        canvas.drawRectangle();
+    }
+
+    void drawTo(Canvas& canvas, const Bounds& viewport, CullStats& stats) const override {
+        ++stats.visited;
+        if (!viewport.intersects(getBounds())) {
+            ++stats.culled;
+            return;
+        }
+        ++stats.drawn;
+        canvas.drawRectangle();
+    }
+
+    void freezeInto(FrozenComposite& frozen) const override;
+
+    void setSize(double newWidth, double newHeight) {
+        width = newWidth;
+        height = newHeight;
+        setBounds(extent());
+        markDirty();
+    }
+
+    void moveTo(double newX, double newY) {
+        x = newX;
+        y = newY;
+        setBounds(extent());
+        markDirty();
+    }
+
+    double getWidth() const {
+        return width;
     }
+
+    double getHeight() const {
+        return height;
+    }
+
+protected:
+    std::size_t record(IncrementalRenderer& renderer, std::size_t, std::size_t) const override {
+        renderer.emit(DrawCommand::Rectangle);
+        return 1;
+    }
+
+private:
+    Bounds extent() const {
+        return Bounds::of(x, y, x + width, y + height);
+    }
+
+    double x;
+    double y;
+    double width;
+    double height;
 };
 
+// Frozen Composite
+// Read-only snapshot of a graphic tree laid out for fast traversal. Each node is a small record in pre-order;
+// a composite's subtreeSize says how many records (itself included) its subtree spans, and a leaf's payloadIndex
+// points into the array holding all leaves of its type.
+class FrozenComposite {
+public:
+    enum class NodeType : std::uint8_t {
+        Composite,
+        Circle,
+        Rectangle
+    };
+
+    struct NodeRecord {
+        NodeType type;
+        std::uint32_t subtreeSize;
+        std::uint32_t payloadIndex;
+    };
+
+    static FrozenComposite freeze(const Graphic& root) {
+        FrozenComposite frozen;
+        root.freezeInto(frozen);
+        return frozen;
+    }
+
+    // Pre-order linear scan, same draw order as the pointer tree
+    void drawTo(Canvas& canvas) const {
+        for (const NodeRecord& node : nodes) {
+            switch (node.type) {
+                case NodeType::Circle:
+                    circles[node.payloadIndex].drawTo(canvas);
+                    break;
+                case NodeType::Rectangle:
+                    rectangles[node.payloadIndex].drawTo(canvas);
+                    break;
+                case NodeType::Composite:
+                    break;
+            }
+        }
+    }
+
+    // All leaves of one type in a row, for when draw order between types does not matter
+    void drawByType(Canvas& canvas) const {
+        for (const Circle& circle : circles) {
+            circle.drawTo(canvas);
+        }
+        for (const Rectangle& rectangle : rectangles) {
+            rectangle.drawTo(canvas);
+        }
+    }
+
+    std::size_t size() const {
+        return nodes.size();
+    }
+
+    const std::vector<NodeRecord>& records() const {
+        return nodes;
+    }
+
+    // Used by Graphic::freezeInto while the snapshot is being built
+    std::size_t beginComposite() {
+        nodes.push_back({NodeType::Composite, 1, 0});
+        return nodes.size() - 1;
+    }
+
+    void endComposite(std::size_t index) {
+        nodes[index].subtreeSize = static_cast<std::uint32_t>(nodes.size() - index);
+    }
+
+    void addCircle(const Circle& circle) {
+        nodes.push_back({NodeType::Circle, 1, static_cast<std::uint32_t>(circles.size())});
+        circles.push_back(circle);
+    }
+
+    void addRectangle(const Rectangle& rectangle) {
+        nodes.push_back({NodeType::Rectangle, 1, static_cast<std::uint32_t>(rectangles.size())});
+        rectangles.push_back(rectangle);
+    }
+
+private:
+    std::vector<NodeRecord> nodes;
+    std::vector<Circle> circles;
+    std::vector<Rectangle> rectangles;
+};
+
+void Circle::freezeInto(FrozenComposite& frozen) const {
+    frozen.addCircle(*this);
+}
+
+void Rectangle::freezeInto(FrozenComposite& frozen) const {
+    frozen.addRectangle(*this);
+}
+
 // Composite
-class CompositeGraphic : public Graphic {
+// A graphic shared by several composites only reports its changes to the one it was added to last.
+class CompositeGraphic : public Graphic, public std::enable_shared_from_this<CompositeGraphic> {
 private:
     std::vector<std::shared_ptr<Graphic>> children;
 
 public:
     void add(const std::shared_ptr<Graphic>& graphic) {
+        // The child's cached offsets were relative to its old place, so the whole subtree is recorded afresh
+        graphic->invalidate();
+        graphic->parent = weak_from_this();
         children.push_back(graphic);
+        markDirty();
+        for (Graphic* node = this; node; ) {
+            node->nodeCount += graphic->nodeCount;
+            std::shared_ptr<Graphic> next = node->parent.lock();
+            node = next.get();
+        }
+        if (!getBounds().contains(graphic->getBounds())) {
+            Bounds grown = getBounds();
+            grown.expand(graphic->getBounds());
+            setBounds(grown);
+        }
+    }
+
+    const std::vector<std::shared_ptr<Graphic>>& getChildren() const override {
+        return children;
+    }
+
+    void drawTo(Canvas& canvas) const override {
+        for (const auto& child : children) {
+            child->drawTo(canvas);
+        }
+    }
+
+    // Prunes the subtree when its box misses the viewport, and stops testing once the box lies entirely inside it
+    void drawTo(Canvas& canvas, const Bounds& viewport, CullStats& stats) const override {
+        ++stats.visited;
+        if (!viewport.intersects(getBounds())) {
+            ++stats.culled;
+            return;
+        }
+        if (viewport.contains(getBounds())) {
+            stats.visited += static_cast<long>(subtreeSize()) - 1;
+            long before = canvas.shapesDrawn();
+            drawTo(canvas);
+            stats.drawn += canvas.shapesDrawn() - before;
+            return;
+        }
+        for (const auto& child : children) {
+            child->drawTo(canvas, viewport, stats);
+        }
+    }
+
+    void freezeInto(FrozenComposite& frozen) const override {
+        std::size_t index = frozen.beginComposite();
+        for (const auto& child : children) {
+            child->freezeInto(frozen);
+        }
+        frozen.endComposite(index);
+    }
+
+protected:
+    std::size_t record(IncrementalRenderer& renderer, std::size_t oldBegin, std::size_t newBegin) const override {
+        std::size_t nodes = 1;
+        for (const auto& child : children) {
+            nodes += child->renderInto(renderer, oldBegin, newBegin);
+        }
+        return nodes;
+    }
+
+    void invalidate() const override {
+        Graphic::invalidate();
+        for (const auto& child : children) {
+            child->invalidate();
+        }
+    }
+};
+
+enum class DrawOrder {
+    Unordered, // each worker keeps its own command list, concatenated in whatever order the work was done
+    Ordered    // same pre-order as Graphic::drawTo, at the cost of one command list per spawned subtree
+};
+
+// Parallel Drawer
+// Spreads the subtrees of a graphic tree across a fixed pool of worker threads. Every worker owns a deque of tasks:
+// it pushes and pops its own work at the back and, when idle, steals from the front of another worker's deque, so the
+// largest outstanding subtrees are the ones that move. A worker that finds nothing to run or steal sleeps on a
+// condition variable until new subtrees are pushed or the pass ends. Subtrees of at most grainSize nodes are drawn with
+// the ordinary sequential recursion.
+class ParallelDrawer {
+public:
+    struct Stats {
+        long tasks = 0;  // subtrees handed out as separate tasks
+        long steals = 0; // tasks taken from another worker's deque
+    };
+
+    explicit ParallelDrawer(unsigned threadCount, std::size_t grainSize = 4096)
+        : grainSize(std::max<std::size_t>(grainSize, 1)), workers(std::max(threadCount, 1u)) {
+        for (unsigned i = 0; i < workers.size(); ++i) {
+            threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ParallelDrawer() {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobStarted.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    ParallelDrawer(const ParallelDrawer&) = delete;
+    ParallelDrawer& operator=(const ParallelDrawer&) = delete;
+
+    // Records the draw commands of the whole tree into frame, replacing what was there
+    void record(const Graphic& root, DrawOrder order, std::vector<DrawCommand>& frame) {
+        Segment rootSegment;
+        ordered = order == DrawOrder::Ordered;
+        for (Worker& worker : workers) {
+            worker.commands.clear();
+        }
+        taskCount = 0;
+        stealCount = 0;
+
+        pending = 1;
+        workers[0].push({&root, &rootSegment});
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            ++generation;
+            jobStarted.notify_all();
+            jobFinished.wait(lock, [this] { return pending == 0 && activeWorkers == 0; });
+        }
+
+        frame.clear();
+        if (ordered) {
+            rootSegment.flattenInto(frame);
+        } else {
+            for (const Worker& worker : workers) {
+                frame.insert(frame.end(), worker.commands.begin(), worker.commands.end());
+            }
+        }
+    }
+
+    // Records the tree in parallel, then replays the commands into the canvas
+    void draw(const Graphic& root, Canvas& canvas, DrawOrder order) {
+        std::vector<DrawCommand> frame;
+        record(root, order, frame);
+        for (DrawCommand command : frame) {
+            canvas.replay(command);
+        }
+    }
+
+    Stats lastPass() const {
+        return {taskCount.load(), stealCount.load()};
+    }
+
+private:
+    // Output of one spawned subtree in ordered mode. Commands of subtrees spawned from it are spliced in at the
+    // position they would have had in a sequential draw.
+    struct Segment {
+        std::vector<DrawCommand> commands;
+        std::vector<std::pair<std::size_t, std::unique_ptr<Segment>>> spliced;
+
+        void flattenInto(std::vector<DrawCommand>& frame) const {
+            std::size_t copied = 0;
+            for (const auto& splice : spliced) {
+                frame.insert(frame.end(), commands.begin() + copied, commands.begin() + splice.first);
+                copied = splice.first;
+                splice.second->flattenInto(frame);
+            }
+            frame.insert(frame.end(), commands.begin() + copied, commands.end());
+        }
+    };
+
+    struct Task {
+        const Graphic* node;
+        Segment* segment;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::vector<DrawCommand> commands;
+
+        void push(Task task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(task);
+        }
+
+        bool popBack(Task& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) {
+                return false;
+            }
+            task = tasks.back();
+            tasks.pop_back();
+            return true;
+        }
+
+        bool stealFront(Task& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) {
+                return false;
+            }
+            task = tasks.front();
+            tasks.pop_front();
+            return true;
+        }
+    };
+
+    void workerLoop(unsigned self) {
+        unsigned long seenGeneration = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobStarted.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) {
+                    return;
+                }
+                seenGeneration = generation;
+                ++activeWorkers;
+            }
+
+            // Idle workers park on workAvailable. The signal count is read before looking at the deques, so a task
+            // pushed after that look always bumps it and the worker does not sleep through it.
+            while (pending.load(std::memory_order_acquire) > 0) {
+                unsigned long seenSignal = workSignals.load();
+                Task task;
+                if (workers[self].popBack(task) || steal(self, task)) {
+                    run(self, task);
+                    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        signalWork(); // the pass is done, release the parked workers
+                    }
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(idleMutex);
+                workAvailable.wait(lock, [&] {
+                    return workSignals.load() != seenSignal || pending.load(std::memory_order_acquire) == 0;
+                });
+            }
+
+            std::lock_guard<std::mutex> lock(jobMutex);
+            if (--activeWorkers == 0) {
+                jobFinished.notify_all();
+            }
+        }
+    }
+
+    bool steal(unsigned self, Task& task) {
+        for (std::size_t offset = 1; offset < workers.size(); ++offset) {
+            if (workers[(self + offset) % workers.size()].stealFront(task)) {
+                stealCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(unsigned self, const Task& task) {
+        taskCount.fetch_add(1, std::memory_order_relaxed);
+        std::vector<DrawCommand>& out = ordered ? task.segment->commands : workers[self].commands;
+        drawSubtree(self, *task.node, task.segment, out);
     }
 
-    void draw() const override {
+    // Draws small subtrees inline and hands the large ones to the pool. Children are spawned in reverse so the
+    // owner pops them back in draw order.
+    void drawSubtree(unsigned self, const Graphic& node, Segment* segment, std::vector<DrawCommand>& out) {
+        if (node.subtreeSize() <= grainSize) {
+            Canvas canvas(&out);
+            node.drawTo(canvas);
+            return;
+        }
+        const std::vector<std::shared_ptr<Graphic>>& children = node.getChildren();
+        std::vector<Task> spawned;
         for (const auto& child : children) {
-            child->draw();
+            if (child->subtreeSize() <= grainSize) {
+                Canvas canvas(&out);
+                child->drawTo(canvas);
+                continue;
+            }
+            Segment* childSegment = nullptr;
+            if (ordered) {
+                segment->spliced.emplace_back(out.size(), std::unique_ptr<Segment>(new Segment()));
+                childSegment = segment->spliced.back().second.get();
+            }
+            spawned.push_back({child.get(), childSegment});
+        }
+        pending.fetch_add(static_cast<long>(spawned.size()), std::memory_order_acq_rel);
+        for (auto it = spawned.rbegin(); it != spawned.rend(); ++it) {
+            workers[self].push(*it);
+        }
+        if (!spawned.empty()) {
+            signalWork();
         }
     }
+
+    // Bumped under idleMutex so a worker between checking its wait condition and blocking cannot miss it
+    void signalWork() {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            workSignals.fetch_add(1);
+        }
+        workAvailable.notify_all();
+    }
+
+    const std::size_t grainSize;
+    std::vector<Worker> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex jobMutex;
+    std::condition_variable jobStarted;
+    std::condition_variable jobFinished;
+    unsigned long generation = 0;
+    unsigned activeWorkers = 0;
+    bool stopping = false;
+
+    std::mutex idleMutex;
+    std::condition_variable workAvailable;
+    std::atomic<unsigned long> workSignals{0};
+
+    bool ordered = false;
+    std::atomic<long> pending{0};
+    std::atomic<long> taskCount{0};
+    std::atomic<long> stealCount{0};
 };
 
-int main() {
+// Builds a balanced tree of about nodeCount nodes with the given fan-out, leaves alternating between the two shapes.
+// Circles are also collected into the optional list so callers can mutate them later.
+std::shared_ptr<Graphic> buildTree(long& remaining, int fanOut, long& leafCounter,
+                                   std::vector<std::shared_ptr<Circle>>* circles = nullptr) {
+    --remaining;
+    if (remaining < fanOut) {
+        if (leafCounter++ % 2 == 0) {
+            std::shared_ptr<Circle> circle = std::make_shared<Circle>();
+            if (circles) {
+                circles->push_back(circle);
+            }
+            return circle;
+        }
+        return std::make_shared<Rectangle>();
+    }
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    for (int i = 0; i < fanOut && remaining > 0; ++i) {
+        // Give each child an equal share of what is left so the tree stays balanced
+        long share = remaining / (fanOut - i);
+        long childRemaining = share;
+        remaining -= share;
+        composite->add(buildTree(childRemaining, fanOut, leafCounter, circles));
+        remaining += childRemaining;
+    }
+    return composite;
+}
+
+// Builds a lopsided tree: at every level the first child gets most of the remaining nodes, so the work is
+// concentrated along one deep spine
+std::shared_ptr<Graphic> buildSkewedTree(long& remaining, int fanOut, long& leafCounter) {
+    --remaining;
+    if (remaining < fanOut) {
+        if (leafCounter++ % 2 == 0) {
+            return std::make_shared<Circle>();
+        }
+        return std::make_shared<Rectangle>();
+    }
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    long heavy = remaining * 3 / 4;
+    long light = (remaining - heavy) / (fanOut - 1);
+    for (int i = 0; i < fanOut && remaining > 0; ++i) {
+        long share = i == 0 ? heavy : light;
+        long childRemaining = std::max(share, 1L);
+        remaining -= childRemaining;
+        composite->add(buildSkewedTree(childRemaining, fanOut, leafCounter));
+        remaining += childRemaining;
+    }
+    return composite;
+}
+
+// Builds a scene of leafCount shapes scattered over a square, split into 2x2 quadrants at every level so each
+// composite covers a compact region
+std::shared_ptr<Graphic> buildSpatialTree(double minX, double minY, double size, long leafCount, std::uint64_t& seed) {
+    auto nextUnit = [&seed] {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return static_cast<double>(seed >> 11) / static_cast<double>(1ULL << 53);
+    };
+    std::shared_ptr<CompositeGraphic> composite = std::make_shared<CompositeGraphic>();
+    if (leafCount <= 8) {
+        double extent = std::min(size, 1.0) / 2;
+        for (long i = 0; i < leafCount; ++i) {
+            double x = minX + nextUnit() * (size - extent);
+            double y = minY + nextUnit() * (size - extent);
+            if (i % 2 == 0) {
+                composite->add(std::make_shared<Circle>(x + extent / 2, y + extent / 2, extent / 2));
+            } else {
+                composite->add(std::make_shared<Rectangle>(x, y, extent, extent));
+            }
+        }
+        return composite;
+    }
+    double half = size / 2;
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        long share = leafCount / 4 + (quadrant < leafCount % 4 ? 1 : 0);
+        composite->add(buildSpatialTree(minX + (quadrant % 2) * half, minY + (quadrant / 2) * half, half, share, seed));
+    }
+    return composite;
+}
+
+void runCullingBenchmark() {
+    const double worldSize = 1000.0;
+    std::uint64_t seed = 88172645463325252ULL;
+    std::shared_ptr<Graphic> root = buildSpatialTree(0.0, 0.0, worldSize, 1000000L, seed);
+
+    const int passes = 20;
+    Canvas canvas;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        root->drawTo(canvas);
+    }
+    std::chrono::duration<double> fullElapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Scene of " << root->subtreeSize() << " nodes, full draw " << fullElapsed.count() * 1000 / passes
+              << " ms" << std::endl;
+
+    for (double selectivity : {0.0001, 0.001, 0.01, 0.1, 0.5, 1.0}) {
+        double side = worldSize * std::sqrt(selectivity);
+        double low = (worldSize - side) / 2;
+        Bounds viewport = Bounds::of(low, low, low + side, low + side);
+        CullStats stats;
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            stats = CullStats();
+            root->drawTo(canvas, viewport, stats);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  viewport " << selectivity * 100 << "% of the scene: " << elapsed.count() * 1000 / passes
+                  << " ms, visited " << stats.visited << " nodes, culled " << stats.culled << " graphics, drew "
+                  << stats.drawn << " shapes" << std::endl;
+    }
+}
+
+void runParallelBenchmark() {
+    const long nodeCount = 4000000L;
+    for (bool skewed : {false, true}) {
+        long remaining = nodeCount;
+        long leafCounter = 0;
+        std::shared_ptr<Graphic> root =
+            skewed ? buildSkewedTree(remaining, 8, leafCounter) : buildTree(remaining, 8, leafCounter);
+
+        const int passes = 5;
+        std::vector<DrawCommand> frame;
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = -1; pass < passes; ++pass) {
+            if (pass == 0) {
+                start = std::chrono::steady_clock::now(); // the first pass only warms up the command buffer
+            }
+            frame.clear();
+            Canvas canvas(&frame);
+            root->drawTo(canvas);
+        }
+        std::chrono::duration<double> sequential = std::chrono::steady_clock::now() - start;
+        std::cout << (skewed ? "Skewed" : "Balanced") << " tree, " << root->subtreeSize() << " nodes, "
+                  << std::thread::hardware_concurrency() << " hardware threads, sequential "
+                  << sequential.count() * 1000 / passes << " ms" << std::endl;
+
+        for (unsigned threadCount : {1u, 2u, 4u, 8u, 16u, 32u}) {
+            ParallelDrawer drawer(threadCount, 4096);
+            for (DrawOrder order : {DrawOrder::Unordered, DrawOrder::Ordered}) {
+                drawer.record(*root, order, frame); // warm up the command buffers
+                start = std::chrono::steady_clock::now();
+                for (int pass = 0; pass < passes; ++pass) {
+                    drawer.record(*root, order, frame);
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                std::cout << "  " << threadCount << " threads, " << (order == DrawOrder::Ordered ? "ordered" : "unordered")
+                          << ": " << elapsed.count() * 1000 / passes << " ms, speedup "
+                          << sequential.count() / elapsed.count() << "x, " << drawer.lastPass().tasks << " tasks, "
+                          << drawer.lastPass().steals << " steals" << std::endl;
+            }
+        }
+    }
+}
+
+void runBenchmark() {
+    for (long nodeCount : {10000L, 1000000L, 10000000L}) {
+        long remaining = nodeCount;
+        long leafCounter = 0;
+        std::shared_ptr<Graphic> root = buildTree(remaining, 8, leafCounter);
+        FrozenComposite frozen = FrozenComposite::freeze(*root);
+
+        const int passes = nodeCount >= 10000000L ? 3 : 20;
+        auto measure = [&](auto drawPass) {
+            Canvas canvas;
+            auto start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < passes; ++pass) {
+                drawPass(canvas);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return static_cast<double>(frozen.size()) * passes / elapsed.count();
+        };
+        double pointerRate = measure([&](Canvas& canvas) { root->drawTo(canvas); });
+        double frozenRate = measure([&](Canvas& canvas) { frozen.drawTo(canvas); });
+        double byTypeRate = measure([&](Canvas& canvas) { frozen.drawByType(canvas); });
+
+        std::cout << frozen.size() << " nodes: pointer tree " << pointerRate << " nodes/sec, frozen pre-order "
+                  << frozenRate << " nodes/sec, frozen by type " << byTypeRate << " nodes/sec" << std::endl;
+    }
+
+    // Incremental frames: change a small fraction of the leaves between frames and redraw only the dirty paths
+    for (long nodeCount : {1000000L, 10000000L}) {
+        long remaining = nodeCount;
+        long leafCounter = 0;
+        std::vector<std::shared_ptr<Circle>> circles;
+        std::shared_ptr<Graphic> root = buildTree(remaining, 8, leafCounter, &circles);
+
+        auto fullStart = std::chrono::steady_clock::now();
+        Canvas canvas;
+        root->drawTo(canvas);
+        std::chrono::duration<double> fullElapsed = std::chrono::steady_clock::now() - fullStart;
+
+        IncrementalRenderer renderer;
+        renderer.render(*root);
+
+        for (double changedFraction : {0.0001, 0.001, 0.01}) {
+            const int frames = 20;
+            const std::size_t changesPerFrame =
+                std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(circles.size()) * changedFraction));
+            std::uint64_t seed = 88172645463325252ULL;
+            long visited = 0;
+            long skipped = 0;
+            std::chrono::duration<double> elapsed{};
+            for (int frame = 0; frame < frames; ++frame) {
+                for (std::size_t change = 0; change < changesPerFrame; ++change) {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 7;
+                    seed ^= seed << 17;
+                    circles[seed % circles.size()]->setRadius(static_cast<double>(frame));
+                }
+                auto start = std::chrono::steady_clock::now();
+                renderer.render(*root);
+                elapsed += std::chrono::steady_clock::now() - start;
+                visited += renderer.lastPass().visited;
+                skipped += renderer.lastPass().skipped;
+            }
+            std::cout << nodeCount << " nodes, " << changedFraction * 100 << "% of circles changed: full redraw "
+                      << fullElapsed.count() * 1000 << " ms, incremental frame " << elapsed.count() * 1000 / frames
+                      << " ms, visited " << visited / frames << ", skipped " << skipped / frames << " nodes per frame"
+                      << std::endl;
+        }
+    }
+
+    runParallelBenchmark();
+    runCullingBenchmark();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     // Create simple shapes
-    std::shared_ptr<Graphic> circle1 = std::make_shared<Circle>();
-    std::shared_ptr<Graphic> circle2 = std::make_shared<Circle>();
-    std::shared_ptr<Graphic> rectangle = std::make_shared<Rectangle>();
+    std::shared_ptr<Graphic> circle1 = std::make_shared<Circle>(0.0, 0.0, 1.0);
+    std::shared_ptr<Graphic> circle2 = std::make_shared<Circle>(10.0, 10.0, 1.0);
+    std::shared_ptr<Graphic> rectangle = std::make_shared<Rectangle>(2.0, 2.0, 3.0, 2.0);
 
     // Create composite graphics
     std::shared_ptr<CompositeGraphic> composite1 = std::make_shared<CompositeGraphic>();
@@ -81,5 +1099,31 @@ int main() {
     // Draw all graphics
     composite2->draw();
 
+    // Freeze the tree into a flat array and draw it by scanning
+    FrozenComposite frozen = FrozenComposite::freeze(*composite2);
+    std::cout << "Frozen tree with " << frozen.size() << " nodes:" << std::endl;
+    Canvas canvas(&std::cout);
+    frozen.drawTo(canvas);
+
+    // Draw incrementally: after one leaf changes only the path above it is recorded again
+    IncrementalRenderer renderer;
+    renderer.render(*composite2);
+    std::static_pointer_cast<Circle>(circle1)->setRadius(2.0);
+    renderer.render(*composite2);
+    std::cout << "Incremental redraw after resizing one circle, visited " << renderer.lastPass().visited
+              << " nodes and skipped " << renderer.lastPass().skipped << ":" << std::endl;
+    renderer.present(canvas);
+
+    // Draw on a work-stealing pool; ordered mode keeps the sequential draw order
+    ParallelDrawer drawer(2, 1);
+    std::cout << "Parallel ordered draw:" << std::endl;
+    drawer.draw(*composite2, canvas, DrawOrder::Ordered);
+
+    // Draw only what overlaps a viewport; circle2 lies outside it and is culled
+    std::cout << "Viewport draw:" << std::endl;
+    CullStats stats = composite2->draw(Bounds::of(-2.0, -2.0, 6.0, 6.0));
+    std::cout << "Visited " << stats.visited << " nodes, culled " << stats.culled << ", drew " << stats.drawn
+              << std::endl;
+
     return 0;
-}
\ No newline at end of file
+}
@@ -11,72 +11,473 @@
 // Decorator: An abstract class that implements the Component interface and has a reference to a Component object. It serves as the base class for all concrete decorators.
 // Concrete Decorators: Classes that extend the Decorator class and add additional responsibilities to the component.
 
+// Decorators are immutable once wrapped, so each one works out its total cost and description length when it is
+// built, from the already-known totals of the beverage it wraps. cost() is then O(1), and getDescription() renders
+// the whole chain once into a single buffer of exactly the right size and returns that cached string afterwards.
+// For re-pricing many orders at once, an OrderBatch stores each order compactly as a base beverage id plus one count
+// per condiment, in columns, and prices the whole batch against a PriceTable: base prices are looked up per order and
+// condiment counts are multiplied and summed eight orders at a time with SSE2, with scalar code elsewhere. Any
+// decorator chain can be added to a batch and prices the same as the chain's own cost().
+// Run the program with "--bench" to compare repeat queries on deep chains against the original recursive decorators,
+// and orders per second of batch pricing against pricing each decorator chain.
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Identifiers used by the batch pricing engine
+enum class BaseBeverage : std::uint8_t {
+    Espresso
+};
+constexpr std::size_t kBaseBeverageCount = 1;
+
+enum class Condiment : std::uint8_t {
+    Milk,
+    Mocha
+};
+constexpr std::size_t kCondimentCount = 2;
+
+// What each item costs; the decorators and PriceTable::standard() both charge these
+constexpr int kEspressoPrice = 10;
+constexpr int kMilkPrice = 15;
+constexpr int kMochaPrice = 30;
+
+// An order reduced to what prices it: the beverage at the bottom of the chain and how often each condiment wraps it
+struct CompactOrder {
+    BaseBeverage base = BaseBeverage::Espresso;
+    std::array<std::uint16_t, kCondimentCount> counts{};
+};
 
 // Component Interface
 class Beverage {
 public:
     virtual ~Beverage() = default;
-    virtual std::string getDescription() const = 0;
+
+    // Rendered on the first call, then returned from the cache
+    const std::string& getDescription() const {
+        std::call_once(descriptionOnce, [this] {
+            description.reserve(descriptionLength());
+            appendDescription(description);
+        });
+        return description;
+    }
+
     virtual int cost() const = 0;
+    virtual std::size_t descriptionLength() const = 0;
+    // Adds this layer (and the layers it wraps) to a compact order
+    virtual void addToOrder(CompactOrder& order) const = 0;
+    // Writes the description of the whole chain to the end of out
+    virtual void appendDescription(std::string& out) const = 0;
+
+private:
+    mutable std::once_flag descriptionOnce;
+    mutable std::string description;
 };
 
 // Concrete Component
 class Espresso : public Beverage {
 public:
-    std::string getDescription() const override {
-        return "Espresso";
+    int cost() const override {
+        return kEspressoPrice;
     }
 
-    int cost() const override {
-        return 10;
+    std::size_t descriptionLength() const override {
+        return kName.size();
     }
+
+    void appendDescription(std::string& out) const override {
+        out += kName;
+    }
+
+    void addToOrder(CompactOrder& order) const override {
+        order.base = BaseBeverage::Espresso;
+    }
+
+private:
+    static constexpr std::string_view kName = "Espresso";
 };
 
 // Decorator
 class CondimentDecorator : public Beverage {
 public:
     virtual ~CondimentDecorator() = default;
-    virtual std::string getDescription() const = 0;
+
+    int cost() const final {
+        return totalCost;
+    }
+
+    std::size_t descriptionLength() const final {
+        return totalLength;
+    }
+
+    void appendDescription(std::string& out) const final {
+        beverage_->appendDescription(out);
+        out += ", ";
+        out += name;
+    }
+
+    void addToOrder(CompactOrder& order) const final {
+        beverage_->addToOrder(order);
+        std::uint16_t& count = order.counts[static_cast<std::size_t>(condiment)];
+        if (count == UINT16_MAX) {
+            throw std::runtime_error("Too many layers of one condiment for a compact order");
+        }
+        ++count;
+    }
+
+protected:
+    CondimentDecorator(std::shared_ptr<Beverage> beverage, Condiment condiment, std::string_view name, int price)
+        : beverage_(std::move(beverage)),
+          condiment(condiment),
+          name(name),
+          totalCost(price + beverage_->cost()),
+          totalLength(beverage_->descriptionLength() + 2 + name.size()) {}
+
+private:
+    std::shared_ptr<Beverage> beverage_;
+    Condiment condiment;
+    std::string_view name;
+    int totalCost;
+    std::size_t totalLength;
 };
 
 // Concrete Decorators
 class Milk : public CondimentDecorator {
 public:
-    Milk(std::shared_ptr<Beverage> beverage) : beverage_(beverage) {}
+    Milk(std::shared_ptr<Beverage> beverage) : CondimentDecorator(std::move(beverage), Condiment::Milk, "Milk", kMilkPrice) {}
+};
+
+class Mocha : public CondimentDecorator {
+public:
+    Mocha(std::shared_ptr<Beverage> beverage) : CondimentDecorator(std::move(beverage), Condiment::Mocha, "Mocha", kMochaPrice) {}
+};
+
+// Prices used by the batch pricing engine, one per base beverage and one per condiment
+struct PriceTable {
+    std::array<int, kBaseBeverageCount> basePrices;
+    std::array<int, kCondimentCount> condimentPrices;
+
+    // The prices the decorator classes charge
+    static PriceTable standard() {
+        return {{kEspressoPrice}, {kMilkPrice, kMochaPrice}};
+    }
+};
+
+// Order Batch
+// Orders stored as columns: one byte of base beverage id per order and one 16-bit count column per condiment.
+class OrderBatch {
+public:
+    void add(const Beverage& beverage) {
+        CompactOrder order;
+        beverage.addToOrder(order);
+        add(order);
+    }
+
+    void add(const CompactOrder& order) {
+        bases.push_back(static_cast<std::uint8_t>(order.base));
+        for (std::size_t c = 0; c < kCondimentCount; ++c) {
+            counts[c].push_back(order.counts[c]);
+        }
+    }
+
+    std::size_t size() const {
+        return bases.size();
+    }
+
+    // Writes the price of every order into prices, using the SIMD kernel where available. Prices are 64-bit because
+    // up to 65535 layers of each condiment times an int price does not fit an int.
+    void priceAll(const PriceTable& table, std::vector<std::int64_t>& prices) const {
+        prices.resize(size());
+        std::size_t done = 0;
+#if defined(__SSE2__)
+        done = priceSse2(table, prices.data());
+#endif
+        priceScalar(table, done, size(), prices.data());
+    }
+
+    // Portable fallback, also used for the tail the vector kernel leaves over
+    void priceScalar(const PriceTable& table, std::size_t begin, std::size_t end, std::int64_t* prices) const {
+        for (std::size_t i = begin; i < end; ++i) {
+            std::int64_t price = table.basePrices[bases[i]];
+            for (std::size_t c = 0; c < kCondimentCount; ++c) {
+                price += static_cast<std::int64_t>(counts[c][i]) * table.condimentPrices[c];
+            }
+            prices[i] = price;
+        }
+    }
+
+private:
+#if defined(__SSE2__)
+    // Eight orders per step: each condiment column is multiplied by its price as unsigned 16-bit lanes, the low and
+    // high product halves interleaved into 32-bit lanes and added. The condiment total is then widened to 64 bits, two
+    // orders per register, and the base prices are added after being gathered with scalar loads (SSE2 has no gather).
+    // Tables whose prices fall outside 0..65535, or whose condiment total could overflow 32 bits, stay scalar.
+    std::size_t priceSse2(const PriceTable& table, std::int64_t* prices) const {
+        std::uint64_t maxCondimentTotal = 0;
+        for (int price : table.condimentPrices) {
+            if (price < 0 || price > UINT16_MAX) {
+                return 0;
+            }
+            maxCondimentTotal += static_cast<std::uint64_t>(UINT16_MAX) * static_cast<std::uint64_t>(price);
+        }
+        if (maxCondimentTotal > UINT32_MAX) {
+            return 0;
+        }
+        __m128i priceVectors[kCondimentCount];
+        for (std::size_t c = 0; c < kCondimentCount; ++c) {
+            priceVectors[c] = _mm_set1_epi16(static_cast<short>(table.condimentPrices[c]));
+        }
+        const __m128i zero = _mm_setzero_si128();
+
+        const std::size_t blocks = size() / 8;
+        for (std::size_t block = 0; block < blocks; ++block) {
+            const std::size_t i = block * 8;
+            __m128i low = zero;
+            __m128i high = zero;
+            for (std::size_t c = 0; c < kCondimentCount; ++c) {
+                __m128i count = _mm_loadu_si128(reinterpret_cast<const __m128i*>(counts[c].data() + i));
+                __m128i productLow = _mm_mullo_epi16(count, priceVectors[c]);
+                __m128i productHigh = _mm_mulhi_epu16(count, priceVectors[c]);
+                low = _mm_add_epi32(low, _mm_unpacklo_epi16(productLow, productHigh));
+                high = _mm_add_epi32(high, _mm_unpackhi_epi16(productLow, productHigh));
+            }
+            const __m128i totals[4] = {_mm_unpacklo_epi32(low, zero), _mm_unpackhi_epi32(low, zero),
+                                       _mm_unpacklo_epi32(high, zero), _mm_unpackhi_epi32(high, zero)};
+            for (std::size_t pair = 0; pair < 4; ++pair) {
+                __m128i base = _mm_set_epi64x(table.basePrices[bases[i + 2 * pair + 1]],
+                                              table.basePrices[bases[i + 2 * pair]]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prices + i + 2 * pair), _mm_add_epi64(base, totals[pair]));
+            }
+        }
+        return blocks * 8;
+    }
+#endif
+
+    std::vector<std::uint8_t> bases;
+    std::array<std::vector<std::uint16_t>, kCondimentCount> counts;
+};
+
+// The original decorators, which recurse through the chain and rebuild the string on every call; for comparison only
+class LegacyBeverage {
+public:
+    virtual ~LegacyBeverage() = default;
+    virtual std::string getDescription() const = 0;
+    virtual int cost() const = 0;
+};
+
+class LegacyEspresso : public LegacyBeverage {
+public:
+    std::string getDescription() const override {
+        return "Espresso";
+    }
+
+    int cost() const override {
+        return kEspressoPrice;
+    }
+};
+
+class LegacyMilk : public LegacyBeverage {
+public:
+    LegacyMilk(std::shared_ptr<LegacyBeverage> beverage) : beverage_(beverage) {}
 
     std::string getDescription() const override {
         return beverage_->getDescription() + ", Milk";
     }
 
     int cost() const override {
-        return 15 + beverage_->cost();
+        return kMilkPrice + beverage_->cost();
     }
 
 private:
-    std::shared_ptr<Beverage> beverage_;
+    std::shared_ptr<LegacyBeverage> beverage_;
 };
 
-class Mocha : public CondimentDecorator {
+class LegacyMocha : public LegacyBeverage {
 public:
-    Mocha(std::shared_ptr<Beverage> beverage) : beverage_(beverage) {}
+    LegacyMocha(std::shared_ptr<LegacyBeverage> beverage) : beverage_(beverage) {}
 
     std::string getDescription() const override {
         return beverage_->getDescription() + ", Mocha";
     }
 
     int cost() const override {
-        return 30 + beverage_->cost();
+        return kMochaPrice + beverage_->cost();
     }
 
 private:
-    std::shared_ptr<Beverage> beverage_;
+    std::shared_ptr<LegacyBeverage> beverage_;
 };
 
+// Counts every global operator new so the benchmark can report heap allocations.
+// The replacements are kept out of line so GCC does not mistake the inlined malloc/free for mismatched allocations.
+std::atomic<long> heapAllocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void runBenchmark() {
+    for (int depth : {2, 8, 32, 128}) {
+        std::shared_ptr<Beverage> beverage = std::make_shared<Espresso>();
+        std::shared_ptr<LegacyBeverage> legacy = std::make_shared<LegacyEspresso>();
+        for (int layer = 0; layer < depth; ++layer) {
+            if (layer % 2 == 0) {
+                beverage = std::make_shared<Milk>(beverage);
+                legacy = std::make_shared<LegacyMilk>(legacy);
+            } else {
+                beverage = std::make_shared<Mocha>(beverage);
+                legacy = std::make_shared<LegacyMocha>(legacy);
+            }
+        }
+        if (beverage->cost() != legacy->cost() || beverage->getDescription() != legacy->getDescription()) {
+            std::cout << "Mismatch at depth " << depth << std::endl;
+            return;
+        }
+
+        const int queries = 2000000 / depth;
+        auto measure = [&](auto query) {
+            std::size_t checksum = 0;
+            long before = heapAllocations;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < queries; ++i) {
+                checksum += query();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double allocations = static_cast<double>(heapAllocations - before) / queries;
+            std::cout << queries / elapsed.count() << " queries/sec, " << allocations << " allocations/query (checksum "
+                      << checksum << ")";
+        };
+        std::cout << "Depth " << depth << ": legacy ";
+        measure([&] { return static_cast<std::size_t>(legacy->cost()) + legacy->getDescription().size(); });
+        std::cout << "; memoized ";
+        measure([&] { return static_cast<std::size_t>(beverage->cost()) + beverage->getDescription().size(); });
+        std::cout << std::endl;
+    }
+}
+
+// Builds a random order as both a decorator chain and its legacy equivalent
+void makeRandomOrder(std::uint64_t& seed, std::shared_ptr<Beverage>& beverage, std::shared_ptr<LegacyBeverage>& legacy) {
+    beverage = std::make_shared<Espresso>();
+    legacy = std::make_shared<LegacyEspresso>();
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    int layers = static_cast<int>(seed % 7);
+    for (int layer = 0; layer < layers; ++layer) {
+        if ((seed >> (8 + layer)) & 1) {
+            beverage = std::make_shared<Milk>(beverage);
+            legacy = std::make_shared<LegacyMilk>(legacy);
+        } else {
+            beverage = std::make_shared<Mocha>(beverage);
+            legacy = std::make_shared<LegacyMocha>(legacy);
+        }
+    }
+}
+
+void runBatchPricingBenchmark() {
+    const std::size_t chainOrders = 200000;
+    const std::size_t batchOrders = 20000000;
+    std::uint64_t seed = 88172645463325252ULL;
+
+    std::vector<std::shared_ptr<Beverage>> beverages;
+    std::vector<std::shared_ptr<LegacyBeverage>> legacyBeverages;
+    OrderBatch batch;
+    for (std::size_t i = 0; i < chainOrders; ++i) {
+        std::shared_ptr<Beverage> beverage;
+        std::shared_ptr<LegacyBeverage> legacy;
+        makeRandomOrder(seed, beverage, legacy);
+        batch.add(*beverage);
+        beverages.push_back(beverage);
+        legacyBeverages.push_back(legacy);
+    }
+
+    std::vector<std::int64_t> prices;
+    batch.priceAll(PriceTable::standard(), prices);
+    for (std::size_t i = 0; i < chainOrders; ++i) {
+        if (prices[i] != beverages[i]->cost() || prices[i] != legacyBeverages[i]->cost()) {
+            std::cout << "Batch price differs from the decorator chain for order " << i << std::endl;
+            return;
+        }
+    }
+
+    long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& legacy : legacyBeverages) {
+        checksum += legacy->cost();
+    }
+    std::chrono::duration<double> chainElapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Decorator chains: " << chainOrders / chainElapsed.count() << " orders/sec (checksum " << checksum
+              << ")" << std::endl;
+
+    // Grow the batch with the same mix of orders so the columns are much larger than the cache
+    while (batch.size() < batchOrders) {
+        CompactOrder order;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        int layers = static_cast<int>(seed % 7);
+        for (int layer = 0; layer < layers; ++layer) {
+            ++order.counts[((seed >> (8 + layer)) & 1) ? 0 : 1];
+        }
+        batch.add(order);
+    }
+
+    PriceTable changed = PriceTable::standard();
+    changed.condimentPrices[static_cast<std::size_t>(Condiment::Milk)] = 20;
+    const int passes = 5;
+    auto measure = [&](const char* label, auto pricePass) {
+        pricePass(); // warm up the output buffer
+        auto begin = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            pricePass();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        long long sum = 0;
+        for (std::int64_t price : prices) {
+            sum += price;
+        }
+        std::cout << label << ": " << static_cast<double>(batch.size()) * passes / elapsed.count()
+                  << " orders/sec (checksum " << sum << ")" << std::endl;
+    };
+    measure("Batch scalar", [&] {
+        prices.resize(batch.size());
+        batch.priceScalar(changed, 0, batch.size(), prices.data());
+    });
+    measure("Batch priceAll", [&] { batch.priceAll(changed, prices); });
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        runBatchPricingBenchmark();
+        return 0;
+    }
 
-int main() {
     // Create an Espresso beverage
     std::shared_ptr<Beverage> beverage = std::make_shared<Espresso>();
     std::cout << beverage->getDescription() << " Rs." << beverage->cost() << std::endl;
@@ -90,4 +491,4 @@ int main() {
     std::cout << beverage->getDescription() << " Rs." << beverage->cost() << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
@@ -10,11 +10,21 @@
 // In this example, Flyweight Pattern is used to minimize memory usage by sharing common tree types (i.e., the intrinsic state) among multiple tree objects. The `TreeType` class represents the intrinsic state (shared data) of trees, such as name, color, and texture. The `TreeFactory` class ensures that only one instance of each unique `TreeType` is created and shared among all trees of that type.
 // When creating trees in the `main` function, we use the `TreeFactory` to get shared instances of `TreeType`. Each `Tree` object contains extrinsic state (i.e., the x and y coordinates) and a reference to the shared `TreeType` instance. This way, the memory footprint is significantly reduced since the intrinsic state is shared, and only the extrinsic state is stored for each individual tree.
 // By drawing each tree, we can see that the shared `TreeType` instances are used to render the trees efficiently, demonstrating the Flyweight Pattern in action.
+// The factory looks tree types up directly by their (name, color, texture) string_views in its own open-addressing
+// table: one hash over the three parts, one probe sequence, and no key string or allocation when the type exists.
+// Every tree type gets an interned integer id, which is cheaper to store and compare than the strings.
+// Run the program with "--bench" to compare lookups per second and allocations against the original string-key factory.
 
 #include <iostream>
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
 
 // Flyweight Interface
 class TreeType {
@@ -31,9 +41,13 @@ private:
     std::string texture;
 
 public:
-    ConcreteTreeType(const std::string& name, const std::string& color, const std::string& texture)
+    ConcreteTreeType(std::string_view name, std::string_view color, std::string_view texture)
         : name(name), color(color), texture(texture) {}
 
+    bool matches(std::string_view otherName, std::string_view otherColor, std::string_view otherTexture) const {
+        return name == otherName && color == otherColor && texture == otherTexture;
+    }
+
     void draw(int x, int y) const override {
         std::cout << "Drawing tree " << name << " of color " << color << " with texture " << texture << " at (" << x << ", " << y << ")\n";
     }
@@ -41,6 +55,85 @@ public:
 
 // FlyweightFactory
 class TreeFactory {
+public:
+    // Returns the interned id of the tree type, creating the type the first time it is asked for
+    int getTreeTypeId(std::string_view name, std::string_view color, std::string_view texture) {
+        const std::size_t h = hash(name, color, texture);
+        if (!slots.empty()) {
+            std::size_t mask = slots.size() - 1;
+            for (std::size_t i = h & mask; slots[i].id >= 0; i = (i + 1) & mask) {
+                if (slots[i].hash == h && types[slots[i].id]->matches(name, color, texture)) {
+                    return slots[i].id;
+                }
+            }
+        }
+        types.push_back(std::make_shared<ConcreteTreeType>(name, color, texture));
+        hashes.push_back(h);
+        int id = static_cast<int>(types.size()) - 1;
+        // Keep the table at most half full so probe sequences stay short
+        if (types.size() * 2 > slots.size()) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        } else {
+            insertSlot(id);
+        }
+        return id;
+    }
+
+    // Tree type for an id handed out by getTreeTypeId
+    const std::shared_ptr<ConcreteTreeType>& treeType(int id) const {
+        return types[id];
+    }
+
+    std::shared_ptr<TreeType> getTreeType(std::string_view name, std::string_view color, std::string_view texture) {
+        return types[getTreeTypeId(name, color, texture)];
+    }
+
+    std::size_t typeCount() const {
+        return types.size();
+    }
+
+private:
+    struct Slot {
+        std::size_t hash;
+        int id; // -1 marks an empty slot
+    };
+
+    // FNV-1a over the three parts, with a 0xFF byte (never valid in UTF-8) between them so
+    // ("ab", "c") and ("a", "bc") hash differently
+    static std::size_t hash(std::string_view name, std::string_view color, std::string_view texture) {
+        std::size_t h = 14695981039346656037ull;
+        for (std::string_view part : {name, color, texture}) {
+            for (char c : part) {
+                h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            h = (h ^ 0xFFu) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    void insertSlot(int id) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hashes[id] & mask;
+        while (slots[i].id >= 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = {hashes[id], id};
+    }
+
+    void rehash(std::size_t slotCount) {
+        slots.assign(slotCount, Slot{0, -1});
+        for (int id = 0; id < static_cast<int>(types.size()); ++id) {
+            insertSlot(id);
+        }
+    }
+
+    std::vector<std::shared_ptr<ConcreteTreeType>> types; // indexed by interned id
+    std::vector<std::size_t> hashes;                      // key hash of each id, kept for rehashing
+    std::vector<Slot> slots;                              // open-addressing table, full hash stored to skip compares
+};
+
+// The original factory, which builds a string key per call and hashes it three times; for comparison only
+class LegacyTreeFactory {
 private:
     std::unordered_map<std::string, std::shared_ptr<TreeType>> treeTypes;
 
@@ -68,7 +161,92 @@ public:
     }
 };
 
-int main() {
+// Counts every global operator new so the benchmark can report heap allocations.
+// The replacements are kept out of line so GCC does not mistake the inlined malloc/free for mismatched allocations.
+std::atomic<long> heapAllocations{0};
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++heapAllocations;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void runBenchmark() {
+    const char* colors[] = {"Green", "Dark Green", "Yellow Green", "Red", "Orange", "Brown", "Silver", "White"};
+    const char* textures[] = {"Rough", "Smooth", "Peeling", "Furrowed", "Scaly"};
+    for (int speciesCount : {10, 100, 1000}) {
+        struct Key {
+            std::string name;
+            std::string color;
+            std::string texture;
+        };
+        std::vector<Key> keys;
+        for (int species = 0; species < speciesCount; ++species) {
+            for (const char* color : colors) {
+                for (const char* texture : textures) {
+                    keys.push_back({"Species number " + std::to_string(species), color, texture});
+                }
+            }
+        }
+        // Spawn order: a pseudo-random walk over the existing types, so every lookup is a hit
+        const int lookups = 4000000;
+        std::vector<int> order(lookups);
+        std::uint64_t seed = 88172645463325252ULL;
+        for (int& index : order) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            index = static_cast<int>(seed % keys.size());
+        }
+
+        LegacyTreeFactory legacy;
+        TreeFactory factory;
+        for (const Key& key : keys) {
+            legacy.getTreeType(key.name, key.color, key.texture);
+            factory.getTreeTypeId(key.name, key.color, key.texture);
+        }
+
+        auto measure = [&](const char* label, auto lookup) {
+            long checksum = 0;
+            long before = heapAllocations;
+            auto start = std::chrono::steady_clock::now();
+            for (int index : order) {
+                checksum += lookup(keys[index]);
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "  " << label << ": " << lookups / elapsed.count() << " lookups/sec, "
+                      << static_cast<double>(heapAllocations - before) / lookups << " allocations/lookup (checksum "
+                      << checksum << ")" << std::endl;
+        };
+        std::cout << keys.size() << " tree types:" << std::endl;
+        measure("string-key factory", [&](const Key& key) {
+            return legacy.getTreeType(key.name, key.color, key.texture).use_count();
+        });
+        measure("tuple lookup, shared_ptr", [&](const Key& key) {
+            return factory.getTreeType(key.name, key.color, key.texture).use_count();
+        });
+        measure("tuple lookup, interned id", [&](const Key& key) {
+            return static_cast<long>(factory.getTreeTypeId(key.name, key.color, key.texture));
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmark();
+        return 0;
+    }
+
     TreeFactory factory;
 
     std::vector<Tree> forest;